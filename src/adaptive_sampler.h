@@ -0,0 +1,204 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace kubvc::math::sampling {
+    // Calculate values for array of samples, both spans have same size
+    using BatchFunction = std::function<void(std::span<const double> samples, std::span<double> values)>;
+
+    static constexpr std::uint32_t DEFAULT_BUDGET = 2048;
+    static constexpr std::uint32_t MIN_BUDGET = 256;
+    static constexpr std::uint32_t MAX_BUDGET = 16384;
+    static constexpr auto DEFAULT_MIN_SPACING = 0.5;
+
+    // Max count of uniform samples which are refined after, there are at least half of them
+    static constexpr std::uint32_t INITIAL_SAMPLES = 128;
+    // Max turn of graph at sample in radians, sharper turns are subdivided
+    static constexpr auto MAX_ANGLE = 0.05;
+    // Max length of segment in pixels, longer ones can hide jumps of value
+    static constexpr auto MAX_SEGMENT_PIXELS = 24.0;
+    // Score of segment between defined and undefined samples, boundary of domain is refined before other segments
+    static constexpr auto BOUNDARY_SCORE = 4.0;
+
+    struct AdaptiveSamplerParams {
+        double min = 0.0;
+        double max = 1.0;
+        // Visible range of values, segments outside of it aren't refined
+        double valueMin = 0.0;
+        double valueMax = 1.0;
+        // Size of pixel along sample and value axes
+        double samplePixel = 1e-3;
+        double valuePixel = 1e-3;
+        // Max count of samples
+        std::uint32_t budget = DEFAULT_BUDGET;
+        // Segments aren't split if their parts are closer than this count of pixels
+        double minSpacing = DEFAULT_MIN_SPACING;
+        // Points of previous sampling of same graph sorted by sample, their values are taken instead of calculation
+        std::span<const glm::dvec2> previous = { };
+        // Refinement is stopped if it returns true, it's checked before each round
+        std::function<bool()> isCancelled = nullptr;
+    };
+
+    struct SamplingStats {
+        std::uint32_t points = 0;
+        // Calculated samples, other ones are taken from previous points
+        std::uint32_t evaluations = 0;
+        // Refinement rounds, each of them is one batch call
+        std::uint32_t rounds = 0;
+        // Refinement is stopped by budget, so some segments could be split more
+        bool isBudgetReached = false;
+    };
+
+    // Coarse samples are placed on global lattice which step is 2^level, so panned view has same samples and 
+    // midpoints between them are calculated exactly. Level is same while zoom is changed less than twice
+    [[nodiscard]] inline std::int32_t getLatticeLevel(double min, double max) {
+        return static_cast<std::int32_t>(std::ceil(std::log2((max - min) / INITIAL_SAMPLES)));
+    }
+
+    // Sample graph starting from uniform coarse samples. Each round splits segments which turn sharply, are too long or
+    // are crossing boundary of domain, all midpoints of round are calculated by one batch call.
+    // Returns points sorted by sample where x is sample and y is value
+    [[nodiscard]] inline std::vector<glm::dvec2> sample(const BatchFunction& f, const AdaptiveSamplerParams& params, SamplingStats& stats) {
+        stats = { };
+        if (!(params.max > params.min) || !std::isfinite(params.max - params.min)) {
+            return { };
+        }
+
+        // Calculate samples which aren't found in previous points, samples and previous points are sorted, so they are walked once
+        std::vector<std::uint32_t> missing;
+        std::vector<double> missingSamples;
+        std::vector<double> missingValues;
+        const auto calculate = [&](std::span<const double> samples, std::span<double> values) {
+            missing.clear();
+            auto it = params.previous.begin();
+            for (std::uint32_t k = 0; k < samples.size(); ++k) {
+                it = std::lower_bound(it, params.previous.end(), samples[k], [](const glm::dvec2& point, double sample) { return point.x < sample; });
+                if (it != params.previous.end() && it->x == samples[k]) {
+                    values[k] = it->y;
+                } else {
+                    missing.push_back(k);
+                }
+            }
+
+            if (missing.empty()) {
+                return;
+            }
+
+            missingSamples.resize(missing.size());
+            missingValues.resize(missing.size());
+            for (std::size_t k = 0; k < missing.size(); ++k) {
+                missingSamples[k] = samples[missing[k]];
+            }
+
+            f(missingSamples, missingValues);
+            for (std::size_t k = 0; k < missing.size(); ++k) {
+                values[missing[k]] = missingValues[k];
+            }
+            stats.evaluations += static_cast<std::uint32_t>(missing.size());
+        };
+
+        const auto step = std::ldexp(1.0, getLatticeLevel(params.min, params.max));
+        const auto first = std::floor(params.min / step);
+        const auto initial = static_cast<std::uint32_t>(std::ceil(params.max / step) - first) + 1;
+        const auto budget = std::max(params.budget, initial);
+
+        std::vector<double> samples(initial);
+        std::vector<double> values(initial);
+        for (std::uint32_t i = 0; i < initial; ++i) {
+            samples[i] = (first + i) * step;
+        }
+        calculate(samples, values);
+
+        std::vector<glm::dvec2> points(initial);
+        for (std::uint32_t i = 0; i < initial; ++i) {
+            points[i] = { samples[i], values[i] };
+        }
+
+        const auto minWidth = params.minSpacing * params.samplePixel * 2.0;
+        const auto isVisible = [&](double a, double b) {
+            return !(a > params.valueMax && b > params.valueMax) && !(a < params.valueMin && b < params.valueMin);
+        };
+
+        std::vector<double> scores;
+        std::vector<std::uint32_t> candidates;
+        std::vector<glm::dvec2> refined;
+        while (points.size() < budget && !(params.isCancelled && params.isCancelled())) {
+            // Score of each segment, it's split if score is greater than one
+            scores.assign(points.size() - 1, 0.0);
+            for (std::size_t i = 0; i + 1 < points.size(); ++i) {
+                const auto& a = points[i];
+                const auto& b = points[i + 1];
+                if (std::isfinite(a.y) != std::isfinite(b.y)) {
+                    scores[i] = BOUNDARY_SCORE;
+                } else if (std::isfinite(a.y) && isVisible(a.y, b.y)) {
+                    scores[i] = std::hypot((b.x - a.x) / params.samplePixel, (b.y - a.y) / params.valuePixel) / MAX_SEGMENT_PIXELS;
+                }
+            }
+
+            // Turn is measured in pixels, so it doesn't depend on scale of axes
+            for (std::size_t i = 1; i + 1 < points.size(); ++i) {
+                const auto& a = points[i - 1];
+                const auto& b = points[i];
+                const auto& c = points[i + 1];
+                if (!std::isfinite(a.y) || !std::isfinite(b.y) || !std::isfinite(c.y) || !isVisible(std::min(a.y, c.y), std::max(a.y, c.y))) {
+                    continue;
+                }
+
+                const glm::dvec2 first = { (b.x - a.x) / params.samplePixel, (b.y - a.y) / params.valuePixel };
+                const glm::dvec2 second = { (c.x - b.x) / params.samplePixel, (c.y - b.y) / params.valuePixel };
+                const auto angle = std::abs(std::atan2(first.x * second.y - first.y * second.x, first.x * second.x + first.y * second.y));
+                scores[i - 1] = std::max(scores[i - 1], angle / MAX_ANGLE);
+                scores[i] = std::max(scores[i], angle / MAX_ANGLE);
+            }
+
+            candidates.clear();
+            for (std::uint32_t i = 0; i < scores.size(); ++i) {
+                if (scores[i] > 1.0 && points[i + 1].x - points[i].x >= minWidth) {
+                    candidates.push_back(i);
+                }
+            }
+
+            if (candidates.empty()) {
+                break;
+            }
+
+            // Worst segments are split first if budget is not enough for all of them
+            const auto remaining = budget - points.size();
+            if (candidates.size() > remaining) {
+                stats.isBudgetReached = true;
+                std::ranges::nth_element(candidates, candidates.begin() + remaining, std::ranges::greater { }, [&](std::uint32_t i) { return scores[i]; });
+                candidates.resize(remaining);
+                std::ranges::sort(candidates);
+            }
+
+            samples.resize(candidates.size());
+            values.resize(candidates.size());
+            for (std::size_t k = 0; k < candidates.size(); ++k) {
+                samples[k] = (points[candidates[k]].x + points[candidates[k] + 1].x) * 0.5;
+            }
+            calculate(samples, values);
+            ++stats.rounds;
+
+            refined.clear();
+            refined.reserve(points.size() + candidates.size());
+            std::size_t next = 0;
+            for (std::uint32_t i = 0; i < points.size(); ++i) {
+                refined.push_back(points[i]);
+                if (next < candidates.size() && candidates[next] == i) {
+                    refined.push_back({ samples[next], values[next] });
+                    ++next;
+                }
+            }
+            std::swap(points, refined);
+        }
+
+        stats.points = static_cast<std::uint32_t>(points.size());
+        return points;
+    }
+}
@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <array>
 #include <complex>
+#include <cstdint>
 
 #include "math_base.h"
 
@@ -110,5 +111,10 @@ namespace kubvc::algorithm {
                 constexpr std::array<uchar, 6> WHITE_SPACE_CASES = { ' ', '\f', '\n', '\r', '\t', '\v' };
                 return std::ranges::any_of(WHITE_SPACE_CASES, [chr](uchar c) { return chr == c; });
             }
+
+            // Mix value into hash, same as boost::hash_combine but for 64 bits
+            static inline constexpr std::uint64_t combineHash(std::uint64_t hash, std::uint64_t value) {
+                return hash ^ (value + 0x9e3779b97f4a7c15ull + (hash << 12) + (hash >> 4));
+            }
     };
 }
\ No newline at end of file
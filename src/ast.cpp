@@ -1,5 +1,7 @@
 #include "ast.h"
 #include <mutex>
+#include <algorithm>
+#include <unordered_set>
 
 namespace kubvc::algorithm { 
     ASTree::~ASTree() {
@@ -20,6 +22,7 @@ namespace kubvc::algorithm {
 
     void ASTree::clear()  {        
         if (isRootExist()) {
+            m_program.store(nullptr, std::memory_order_seq_cst); 
             m_treeCached.store(nullptr, std::memory_order_seq_cst); 
             std::unique_lock lock(m_mutex);
             while(!m_treeStack.empty()) {
@@ -46,8 +49,8 @@ namespace kubvc::algorithm {
 
         std::unique_lock lock(m_mutex);
         m_treeStack = std::move(stack.value());
-        m_treeCached.store(nullptr, std::memory_order_release); 
-        return true;         
+        makeTreeCache();
+        return compileProgram();         
     }
 
     bool ASTree::validateFrom(std::shared_ptr<kubvc::algorithm::INode> start) const {        
@@ -59,15 +62,25 @@ namespace kubvc::algorithm {
         if (!start) {
             return std::nullopt;
         }
-        std::stack<std::shared_ptr<INode>> tempStack;
-        tempStack.push(start);
 
-        std::stack<std::shared_ptr<INode>> stack;
+        // Tree can be a DAG after builder merged same subtrees, so we are walk it in post order 
+        // and shared node is expanded only once, next visits are only pushing the node itself 
+        // as a reference to already calculated value
+        std::stack<std::pair<std::shared_ptr<INode>, bool>> tempStack;
+        tempStack.push({ start, false });
+
+        std::unordered_set<const INode*> visited;
+        std::vector<std::shared_ptr<INode>> order;
         while (!tempStack.empty()) {
-            auto nodeInterface = tempStack.top();
-            stack.push(nodeInterface);
+            auto [nodeInterface, isExpanded] = tempStack.top();
             tempStack.pop();
 
+            if (isExpanded || !visited.insert(nodeInterface.get()).second) {
+                order.push_back(std::move(nodeInterface));
+                continue;
+            }
+
+            tempStack.push({ nodeInterface, true });
             switch (nodeInterface->getType()) {
                 case kubvc::algorithm::NodeTypes::Operator: {
                     const auto node = castToNodePtr<NodeTypes::Operator>(nodeInterface); 
@@ -75,8 +88,8 @@ namespace kubvc::algorithm {
                         return std::nullopt;
                     }
 
-                    tempStack.push(node->left);                 
-                    tempStack.push(node->right);                 
+                    tempStack.push({ node->right, false });                 
+                    tempStack.push({ node->left, false });                 
                     break;    
                 }
                 case kubvc::algorithm::NodeTypes::UnaryOperator: {
@@ -85,7 +98,7 @@ namespace kubvc::algorithm {
                         return std::nullopt;
                     }
 
-                    tempStack.push(node->child);         
+                    tempStack.push({ node->child, false });         
                     break;     
                 }
                 case kubvc::algorithm::NodeTypes::Function: {
@@ -94,7 +107,7 @@ namespace kubvc::algorithm {
                         return std::nullopt;
                     }
 
-                    tempStack.push(node->argument);         
+                    tempStack.push({ node->argument, false });         
                     break;
                 }
                 case kubvc::algorithm::NodeTypes::Root: {
@@ -103,7 +116,7 @@ namespace kubvc::algorithm {
                         return std::nullopt;
                     }
 
-                    tempStack.push(node->child);  
+                    tempStack.push({ node->child, false });  
                     break;
                 }
                 // This nodes are doesn't have any childrens 
@@ -120,6 +133,12 @@ namespace kubvc::algorithm {
             }
         }
         
+        // First node in postfix order must be on top
+        std::stack<std::shared_ptr<INode>> stack;
+        for (auto it = order.rbegin(); it != order.rend(); ++it) {
+            stack.push(std::move(*it));
+        }
+
         return stack;
     }
     
@@ -147,157 +166,73 @@ namespace kubvc::algorithm {
         m_treeCached.store(std::move(newCache), std::memory_order_release);
     }
     
-    constexpr std::size_t VALUE_STACK_SIZE = 512;
-
-    double ASTree::calculate(double x, double y) {
-        if (!isRootExist()) {
-            return std::numeric_limits<double>::quiet_NaN();
-        }
-
-        auto cached = m_treeCached.load(std::memory_order_acquire);
+    bool ASTree::compileProgram() {
+        const auto cached = m_treeCached.load(std::memory_order_acquire);
         if (!cached) {
-            std::unique_lock lock { m_mutex }; 
-            // Check again with lock
-            cached = m_treeCached.load(std::memory_order_relaxed);
-            if (!cached) {
-                makeTreeCache();
-                cached = m_treeCached.load(std::memory_order_relaxed);
-                // So, if cache is still empty, return
-                if (!cached) {
-                    return std::numeric_limits<double>::quiet_NaN();
-                }
-
-            }
-        }
-   
-        KUB_ASSERT(cached->size() < VALUE_STACK_SIZE, "ast: cached size > value stack size");
-
-        if (!cached || cached->empty()) {
-            return std::numeric_limits<double>::quiet_NaN();
+            m_program.store(nullptr, std::memory_order_release);
+            return false;
         }
-        
-        thread_local static double valueStack[VALUE_STACK_SIZE];
-        std::size_t top = 0;
-        for (const auto& node : (*cached)) {            
-            switch (node->getType()) {
-                case kubvc::algorithm::NodeTypes::Operator: {
-                    if (top < 2) {
-                        KUB_ERROR("Stack underflow at Operator node");
-                        return std::numeric_limits<double>::quiet_NaN();
-                    }
 
-                    auto right = valueStack[--top]; 
-                    auto left = valueStack[--top]; 
-                    valueStack[top++] = node->calculate(left, right);
-                    break;    
-                }
-                case kubvc::algorithm::NodeTypes::Root: 
-                case kubvc::algorithm::NodeTypes::Function:
-                case kubvc::algorithm::NodeTypes::UnaryOperator: {
-                    if (top == 0) {
-                        KUB_ERROR("Stack underflow at unary node");
-                        return std::numeric_limits<double>::quiet_NaN();
-                    }
+        auto program = Program::compile(*cached, m_jitEnabled.load(std::memory_order_acquire));
+        const auto isCompiled = program != nullptr;
+        m_program.store(std::move(program), std::memory_order_release);
+        return isCompiled;
+    }
 
-                    auto operand = valueStack[--top]; 
-                    valueStack[top++] = node->calculate(operand, 0.0);
-                    break;     
-                }
-                case kubvc::algorithm::NodeTypes::Number:
-                case kubvc::algorithm::NodeTypes::Variable:
-                case kubvc::algorithm::NodeTypes::ComplexNumber:
-                    valueStack[top++] = node->calculate(x, y);
-                    break;
-                case kubvc::algorithm::NodeTypes::None:
-                case kubvc::algorithm::NodeTypes::Invalid:
-                    break;  
-            }
-        }
-        
-        if (top == 0) 
+    double ASTree::calculate(double x, double y) {
+        const auto program = m_program.load(std::memory_order_acquire);
+        if (!program) {
             return std::numeric_limits<double>::quiet_NaN();
+        }
 
-        return valueStack[--top]; 
+        return program->calculate(x, y);
     }            
     
     std::complex<double> ASTree::calculateComplex(double re, double im) {
-        if (!isRootExist()) {
+        const auto program = m_program.load(std::memory_order_acquire);
+        if (!program) {
             return { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN() };
         }
 
-        auto cached = m_treeCached.load(std::memory_order_acquire);
-        if (!cached) {
-            std::unique_lock lock { m_mutex }; 
-            // Check again with lock
-            cached = m_treeCached.load(std::memory_order_relaxed);
-            if (!cached) {
-                makeTreeCache();
-                cached = m_treeCached.load(std::memory_order_relaxed);
-                // So, if cache is still empty, return
-                if (!cached) {
-                    return { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN() };
-                }
-            }
-        }
+        return program->calculateComplex(re, im);
+    }
 
-        KUB_ASSERT(cached->size() < VALUE_STACK_SIZE, "ast: cached size > value stack size");
-        
-        if (!cached || cached->empty()) {
+    math::Dual ASTree::calculateDual(double x, double y, DerivativeVariable variable) {
+        const auto program = m_program.load(std::memory_order_acquire);
+        if (!program) {
             return { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN() };
         }
 
-        thread_local static std::complex<double> valueStack[VALUE_STACK_SIZE];
-        std::size_t top = 0;
-        for (auto& node : (*cached)) {  
-            switch (node->getType()) {
-                case kubvc::algorithm::NodeTypes::Operator: {       
-                    if (top < 2) {
-                        KUB_ERROR("Stack underflow at Operator node");
-                        return std::numeric_limits<double>::quiet_NaN();
-                    }
+        return program->calculateDual(x, y, variable);
+    }
 
-                    // Get left/right node for operators
-                    auto right = valueStack[--top];                     
-                    auto left = valueStack[--top]; 
+    math::Interval ASTree::calculateInterval(const math::Interval& x, const math::Interval& y) {
+        const auto program = m_program.load(std::memory_order_acquire);
+        if (!program) {
+            return math::Interval::empty();
+        }
 
-                    // Calculate operator result 
-                    auto operatorNode = castToNodePtr<NodeTypes::Operator>(node); 
-                    valueStack[top++] = operatorNode->calculateComplexOperator(left, right);
-                    break;    
-                }
-                case kubvc::algorithm::NodeTypes::UnaryOperator:
-                case kubvc::algorithm::NodeTypes::Root: 
-                case kubvc::algorithm::NodeTypes::Function: {
-                    if (top == 0) {
-                        KUB_ERROR("Stack underflow at unary node");
-                        return std::numeric_limits<double>::quiet_NaN();
-                    }
+        return program->calculateInterval(x, y);
+    }
 
-                    auto operand = valueStack[--top]; 
-                    valueStack[top++] = node->calculateComplex(operand.real(), operand.imag());
-                    break;     
-                }
-                // This nodes are doesn't have any childrens 
-                case kubvc::algorithm::NodeTypes::Number:
-                case kubvc::algorithm::NodeTypes::Variable:
-                case kubvc::algorithm::NodeTypes::ComplexNumber:
-                    valueStack[top++] = node->calculateComplex(re, im);
-                    break;
-                case kubvc::algorithm::NodeTypes::Invalid: 
-                case kubvc::algorithm::NodeTypes::None: 
-                    break;               
-                default: {
-                    KUB_ASSERT(false, "Unknown node type {}", static_cast<std::int32_t>(node->getType()));
-                    break;
-                }
-            }        
-        } 
+    void ASTree::calculateBatch(std::span<const double> xs, std::span<const double> ys, std::span<double> out) {
+        const auto program = m_program.load(std::memory_order_acquire);
+        if (!program) {
+            std::ranges::fill(out, std::numeric_limits<double>::quiet_NaN());
+            return;
+        }
 
-        if (top == 0) {
-            return { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN() };
+        program->calculateBatch(xs, ys, out);
+    }
+
+    void ASTree::calculateComplexBatch(std::span<const double> re, std::span<const double> im, std::span<std::complex<double>> out) {
+        const auto program = m_program.load(std::memory_order_acquire);
+        if (!program) {
+            std::ranges::fill(out, std::complex<double> { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN() });
+            return;
         }
 
-        return valueStack[--top];
+        program->calculateComplexBatch(re, im, out);
     }
 
     TreeCacheView ASTree::getTreeCached() const {
@@ -310,4 +245,21 @@ namespace kubvc::algorithm {
 
         return TreeCacheView { cached };
     }
+
+    std::shared_ptr<const Program> ASTree::getProgram() const {
+        return m_program.load(std::memory_order_acquire);
+    }
+
+    void ASTree::setJitEnabled(bool enabled) {
+        m_jitEnabled.store(enabled, std::memory_order_release);
+
+        std::unique_lock lock(m_mutex);
+        if (m_treeCached.load(std::memory_order_acquire) != nullptr) {
+            [[maybe_unused]] const auto isCompiled = compileProgram();
+        }
+    }
+
+    bool ASTree::isJitEnabled() const {
+        return m_jitEnabled.load(std::memory_order_acquire);
+    }
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #pragma once
 #include "ast_nodes.h"
+#include "ast_program.h"
 
 #include <shared_mutex>
 #include <stack>
@@ -48,13 +49,33 @@ namespace kubvc::algorithm {
 
             // Calcualate in complex mode
             [[nodiscard]] std::complex<double> calculateComplex(double re, double im);
+
+            // Calculate in real mode with derivative by variable
+            [[nodiscard]] math::Dual calculateDual(double x, double y, DerivativeVariable variable);
+
+            // Calculate in real mode over intervals of variables, result contains all values in this region
+            [[nodiscard]] math::Interval calculateInterval(const math::Interval& x, const math::Interval& y);
+
+            // Calculate in real mode for whole arrays of samples, all spans must have same size
+            void calculateBatch(std::span<const double> xs, std::span<const double> ys, std::span<double> out);
+
+            // Calculate in complex mode for whole arrays of samples, all spans must have same size
+            void calculateComplexBatch(std::span<const double> re, std::span<const double> im, std::span<std::complex<double>> out);
             
             // Get cached tree stack  
             [[nodiscard]] TreeCacheView getTreeCached() const; 
+
+            // Get program compiled from tree cache 
+            [[nodiscard]] std::shared_ptr<const Program> getProgram() const;
+
+            // Use native code for real mode calculations, program is recompiled if tree is already built
+            void setJitEnabled(bool enabled);
+            [[nodiscard]] bool isJitEnabled() const;
             
         private:
             [[nodiscard]] std::optional<std::stack<std::shared_ptr<INode>>> constructTreeStack(std::shared_ptr<INode> start) const;
             void makeTreeCache();
+            [[nodiscard]] bool compileProgram();
 
             // Current tree stack 
             std::stack<std::shared_ptr<INode>> m_treeStack;
@@ -63,6 +84,9 @@ namespace kubvc::algorithm {
             // also vector is pointer because some threads can use old cache
             // and it's a node cache using for calculations              
             std::atomic<std::shared_ptr<std::vector<std::shared_ptr<INode>>>> m_treeCached;
+            // Flat instruction stream which is used for calculations 
+            std::atomic<std::shared_ptr<const Program>> m_program;
+            std::atomic<bool> m_jitEnabled = false;
             std::atomic<NodePtr<NodeTypes::Root>> m_root;
 
             mutable std::shared_mutex m_mutex;
@@ -4,16 +4,56 @@
 #include "lexer.h"
 #include "logger.h"
 #include "variable_dependence.h"
+#include "operators.h"
 
 #include <stack>
 #include <queue>
-#include <charconv>
+#include <unordered_map>
+#include <bit>
+#include <atomic>
 
 namespace kubvc::algorithm {
+    // Structural key of node, children are compared by address, because they are already merged
+    struct NodeKey {
+        NodeTypes type = NodeTypes::None;
+        char operation = '\0';
+        std::uint64_t real = 0;
+        std::uint64_t imag = 0;
+        std::string_view name;
+        const INode* left = nullptr;
+        const INode* right = nullptr;
+
+        bool operator==(const NodeKey&) const = default;
+    };
+
+    struct NodeKeyHash {
+        std::size_t operator()(const NodeKey& key) const noexcept {
+            auto hash = std::hash<std::string_view>{ }(key.name);
+            const auto combine = [&hash](std::size_t value) {
+                hash ^= value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+            };
+            combine(static_cast<std::size_t>(key.type));
+            combine(static_cast<std::size_t>(key.operation));
+            combine(std::hash<std::uint64_t>{ }(key.real));
+            combine(std::hash<std::uint64_t>{ }(key.imag));
+            combine(std::hash<const INode*>{ }(key.left));
+            combine(std::hash<const INode*>{ }(key.right));
+            return hash;
+        }
+    };
+
     class ASTBuilder : public utility::Singleton<ASTBuilder> {
         public:
             bool build(ASTree& tree, math::VariableDependenceController& vdc, const std::vector<Token>& tokens);
 
+            // Build simplified derivative of subtree by variable, source nodes are not changed.
+            // Returns nullptr if some function or operator doesn't have derivative
+            [[nodiscard]] std::shared_ptr<INode> differentiate(const std::shared_ptr<INode>& node, DerivativeVariable variable) const;
+
+            // Build tree of derivative of source expression by variable, it's used by solvers which need second derivative.
+            // Returns false if derivative can't be built
+            bool buildDerivative(ASTree& tree, const ASTree& source, const math::VariableDependenceController& vdc, DerivativeVariable variable) const;
+
         private:        
             [[nodiscard]] NodePtr<NodeTypes::Root> createRoot(std::shared_ptr<INode> child) const;
             [[nodiscard]] NodePtr<NodeTypes::Variable> createVariableNode(char value) const;
@@ -24,6 +64,32 @@ namespace kubvc::algorithm {
             [[nodiscard]] NodePtr<NodeTypes::Invalid> createInvalidNode(std::string_view name) const;
             [[nodiscard]] NodePtr<NodeTypes::Function> createFunctionNode(std::string_view name) const;
 
+            // Fold constant subtrees and remove operations which don't change value, returns new subtree root
+            [[nodiscard]] std::shared_ptr<INode> simplify(std::shared_ptr<INode> node) const;
+            // Rotate and fold operator which sides are simplified already
+            [[nodiscard]] std::shared_ptr<INode> simplifyOperator(NodePtr<NodeTypes::Operator> operatorNode) const;
+            // Calculate constant in both modes, returns nothing if results are different, 
+            // because mode can be switched without rebuilding the tree 
+            [[nodiscard]] std::optional<double> foldConstant(double real, const std::complex<double>& complex) const;
+
+            [[nodiscard]] std::shared_ptr<INode> clone(const std::shared_ptr<INode>& node) const;
+            [[nodiscard]] std::shared_ptr<INode> derive(const std::shared_ptr<INode>& node, DerivativeVariable variable) const;
+            // Derivative of function by its argument without chain rule
+            [[nodiscard]] std::shared_ptr<INode> createFunctionDerivative(std::string_view name, const std::shared_ptr<INode>& argument) const;
+            // Create operator node, but skip it if one of sides is zero or one, derivative trees have a lot of them
+            [[nodiscard]] std::shared_ptr<INode> combine(std::shared_ptr<INode> x, std::shared_ptr<INode> y, char op) const;
+
+            using NodeTable = std::unordered_map<NodeKey, std::shared_ptr<INode>, NodeKeyHash>;
+            // Replace structurally identical subtrees by one node, so tree becomes a DAG 
+            // and each shared value is calculated once by program
+            [[nodiscard]] std::shared_ptr<INode> merge(std::shared_ptr<INode> node, NodeTable& table, const math::VariableDependenceController& vdc) const;
+
+            // Find which variables are used by subtree, parameters are skipped. 
+            // Variables except y are calculated as x in real mode, so they are counted as x
+            void findVariables(const std::shared_ptr<INode>& node, bool& hasX, bool& hasY) const;
+            // Check if value side of expression doesn't depend on variable which is solved
+            [[nodiscard]] math::VDC::ExpressionForm classify(const std::shared_ptr<INode>& node, const math::VDC& vdc) const;
+
             template <NodeTypes NodeType>
             [[nodiscard]] NodePtr<NodeType> createNode() const;
 
@@ -31,10 +97,10 @@ namespace kubvc::algorithm {
 
     template <NodeTypes NodeType>
     inline NodePtr<NodeType> ASTBuilder::createNode() const {
-        static std::uint32_t id = 0;
+        // Derivatives are built from GUI thread while tasks are building trees, so counter is atomic
+        static std::atomic<std::uint32_t> id = 0;
         const auto node = std::make_shared<NodeTraits<NodeType>>();
-        node->setId(id);
-        id++;
+        node->setId(id.fetch_add(1, std::memory_order_relaxed));
         return node;
     }
 
@@ -87,9 +153,544 @@ namespace kubvc::algorithm {
     inline NodePtr<NodeTypes::Function> ASTBuilder::createFunctionNode(std::string_view name) const {
         const auto node = createNode<NodeTypes::Function>();
         node->name = name;
+        // Bind handlers for both modes, because mode can be switched without rebuilding the tree
+        node->realFunction = utility::container::get(math::containers::Functions, name).value_or(nullptr);
+        node->complexFunction = utility::container::get(math::containers::ComplexFunctions, name).value_or(nullptr);
+        node->realDerivative = utility::container::get(math::containers::DerivativeFunctions, name).value_or(nullptr);
+        node->intervalFunction = utility::container::get(math::containers::IntervalFunctions, name).value_or(nullptr);
         return node;
     }
     
+    inline std::optional<double> ASTBuilder::foldConstant(double real, const std::complex<double>& complex) const {
+        const auto isSame = (real == complex.real() && complex.imag() == 0.0) || (glm::isnan(real) && glm::isnan(complex.real()));
+        if (!isSame) {
+            return std::nullopt;
+        }
+
+        return real;
+    }
+
+    static inline std::optional<double> getNumberValue(const std::shared_ptr<INode>& node) {
+        if (node->getType() != NodeTypes::Number) {
+            return std::nullopt;
+        }
+
+        return castToNodePtr<NodeTypes::Number>(node)->getValue();
+    }
+
+    static inline bool isNumberEqual(const std::shared_ptr<INode>& node, double value) {
+        const auto number = getNumberValue(node);
+        return number.has_value() && number.value() == value;
+    }
+
+    inline std::shared_ptr<INode> ASTBuilder::simplify(std::shared_ptr<INode> node) const {
+        switch (node->getType()) {
+            case NodeTypes::Operator: {
+                const auto operatorNode = castToNodePtr<NodeTypes::Operator>(node);
+                operatorNode->left = simplify(operatorNode->left);
+                operatorNode->right = simplify(operatorNode->right);
+                return simplifyOperator(operatorNode);
+            }
+            case NodeTypes::UnaryOperator: {
+                const auto unaryNode = castToNodePtr<NodeTypes::UnaryOperator>(node);
+                unaryNode->child = simplify(unaryNode->child);
+
+                const auto type = getOperatorTypeByChar(unaryNode->operation);
+                if (type == Operators::Plus) {
+                    return unaryNode->child;
+                }
+
+                if (type == Operators::Minus) {
+                    const auto number = getNumberValue(unaryNode->child);
+                    if (number.has_value()) {
+                        return createNumberNode(-number.value());
+                    }
+
+                    // Double negation
+                    if (unaryNode->child->getType() == NodeTypes::UnaryOperator) {
+                        const auto childNode = castToNodePtr<NodeTypes::UnaryOperator>(unaryNode->child);
+                        if (getOperatorTypeByChar(childNode->operation) == Operators::Minus) {
+                            return childNode->child;
+                        }
+                    }
+                }
+
+                return node;
+            }
+            case NodeTypes::Function: {
+                const auto functionNode = castToNodePtr<NodeTypes::Function>(node);
+                functionNode->argument = simplify(functionNode->argument);
+
+                const auto argument = getNumberValue(functionNode->argument);
+                if (argument.has_value() && functionNode->realFunction != nullptr && functionNode->complexFunction != nullptr) {
+                    const auto folded = foldConstant(functionNode->realFunction(argument.value()), 
+                        functionNode->complexFunction(std::complex<double>(argument.value(), 0.0)));
+                    if (folded.has_value()) {
+                        return createNumberNode(folded.value());
+                    }
+                }
+
+                return node;
+            }
+            default:
+                return node;
+        }
+    }
+
+    inline std::shared_ptr<INode> ASTBuilder::simplifyOperator(NodePtr<NodeTypes::Operator> operatorNode) const {
+        const auto type = getOperatorTypeByChar(operatorNode->operation);
+        // Equal is parsed first and it's returns right side, so (y = a) * b is same as y = (a * b),
+        // we are rotate it to give a chance to fold right side. Sides are simplified already, 
+        // so only new node is simplified, otherwise long chain y = a + b + c + ... is simplified again on each rotation
+        if (type != Operators::Equal && operatorNode->left->getType() == NodeTypes::Operator) {
+            const auto equalNode = castToNodePtr<NodeTypes::Operator>(operatorNode->left);
+            if (getOperatorTypeByChar(equalNode->operation) == Operators::Equal) {
+                operatorNode->left = equalNode->right;
+                equalNode->right = simplifyOperator(operatorNode);
+                return equalNode;
+            }
+        }
+
+        const auto left = getNumberValue(operatorNode->left);
+        const auto right = getNumberValue(operatorNode->right);
+        if (type != Operators::Equal && left.has_value() && right.has_value()) {
+            const auto folded = foldConstant(calculateOperator(type, left.value(), right.value()), 
+                calculateComplexOperator(type, left.value(), right.value()));
+            if (folded.has_value()) {
+                return createNumberNode(folded.value());
+            }
+        }
+
+        // Identities are exact, except x + 0 which can change only sign of zero 
+        switch (type) {
+            case Operators::Plus:
+                if (isNumberEqual(operatorNode->right, 0.0)) {
+                    return operatorNode->left;
+                } 
+                
+                if (isNumberEqual(operatorNode->left, 0.0)) {
+                    return operatorNode->right;
+                }
+                break;
+            case Operators::Minus:
+                if (isNumberEqual(operatorNode->right, 0.0)) {
+                    return operatorNode->left;
+                }
+                break;
+            case Operators::Multiplication:
+                if (isNumberEqual(operatorNode->right, 1.0)) {
+                    return operatorNode->left;
+                } 
+                
+                if (isNumberEqual(operatorNode->left, 1.0)) {
+                    return operatorNode->right;
+                }
+                break;
+            case Operators::Division:
+            case Operators::Power:
+                if (isNumberEqual(operatorNode->right, 1.0)) {
+                    return operatorNode->left;
+                }
+                break;
+            default:
+                break;
+        }
+        
+        return operatorNode;
+    }
+
+    inline std::shared_ptr<INode> ASTBuilder::merge(std::shared_ptr<INode> node, NodeTable& table, const math::VariableDependenceController& vdc) const {
+        NodeKey key { };
+        key.type = node->getType();
+        switch (key.type) {
+            case NodeTypes::Operator: {
+                const auto operatorNode = castToNodePtr<NodeTypes::Operator>(node);
+                operatorNode->left = merge(operatorNode->left, table, vdc);
+                operatorNode->right = merge(operatorNode->right, table, vdc);
+                key.operation = operatorNode->operation;
+                key.left = operatorNode->left.get();
+                key.right = operatorNode->right.get();
+                break;
+            }
+            case NodeTypes::UnaryOperator: {
+                const auto unaryNode = castToNodePtr<NodeTypes::UnaryOperator>(node);
+                unaryNode->child = merge(unaryNode->child, table, vdc);
+                key.operation = unaryNode->operation;
+                key.left = unaryNode->child.get();
+                break;
+            }
+            case NodeTypes::Function: {
+                const auto functionNode = castToNodePtr<NodeTypes::Function>(node);
+                functionNode->argument = merge(functionNode->argument, table, vdc);
+                // Each call of function like rnd must give own value
+                if (std::ranges::find(math::containers::NonDeterministicFunctions, functionNode->name) != 
+                    math::containers::NonDeterministicFunctions.end()) {
+                    return node;
+                }
+
+                key.name = functionNode->name;
+                key.left = functionNode->argument.get();
+                break;
+            }
+            case NodeTypes::Number:
+                key.real = std::bit_cast<std::uint64_t>(castToNodePtr<NodeTypes::Number>(node)->getValue());
+                break;
+            case NodeTypes::ComplexNumber: {
+                const auto value = castToNodePtr<NodeTypes::ComplexNumber>(node)->getValue();
+                key.real = std::bit_cast<std::uint64_t>(value.real());
+                key.imag = std::bit_cast<std::uint64_t>(value.imag());
+                break;
+            }
+            case NodeTypes::Variable: {
+                const auto variableNode = castToNodePtr<NodeTypes::Variable>(node);
+                // Parameter value is edited only in node which is saved in vdc, 
+                // so all parameters with same name must point to it 
+                if (variableNode->isParameter) {
+                    const auto parameters = vdc.getParameterVariables();
+                    const auto it = std::ranges::find_if(parameters, [&variableNode](const auto& parameter) { 
+                        return parameter->getValue() == variableNode->getValue(); 
+                    });
+                    if (it != parameters.end()) {
+                        return *it;
+                    }
+                }
+
+                key.operation = variableNode->getValue();
+                key.real = variableNode->isParameter;
+                break;
+            }
+            default:
+                return node;
+        }
+
+        const auto [it, isInserted] = table.try_emplace(key, node);
+        return it->second;
+    }
+
+    inline std::shared_ptr<INode> ASTBuilder::clone(const std::shared_ptr<INode>& node) const {
+        switch (node->getType()) {
+            case NodeTypes::Operator: {
+                const auto operatorNode = castToNodePtr<NodeTypes::Operator>(node);
+                return createOperatorNode(clone(operatorNode->left), clone(operatorNode->right), operatorNode->operation);
+            }
+            case NodeTypes::UnaryOperator: {
+                const auto unaryNode = castToNodePtr<NodeTypes::UnaryOperator>(node);
+                return createUnaryOperatorNode(clone(unaryNode->child), unaryNode->operation);
+            }
+            case NodeTypes::Function: {
+                const auto functionNode = castToNodePtr<NodeTypes::Function>(node);
+                const auto newNode = createFunctionNode(functionNode->name);
+                newNode->argument = clone(functionNode->argument);
+                return newNode;
+            }
+            case NodeTypes::Number:
+                return createNumberNode(castToNodePtr<NodeTypes::Number>(node)->getValue());
+            case NodeTypes::ComplexNumber:
+                return createComplexNumber();
+            case NodeTypes::Variable: {
+                // Parameter node is shared, so its value can be changed after tree is built
+                const auto variableNode = castToNodePtr<NodeTypes::Variable>(node);
+                if (variableNode->isParameter) {
+                    return node;
+                }
+
+                return createVariableNode(variableNode->getValue());
+            }
+            case NodeTypes::Invalid:
+                return createInvalidNode(castToNodePtr<NodeTypes::Invalid>(node)->name);
+            default:
+                return nullptr;
+        }
+    }
+
+    inline std::shared_ptr<INode> ASTBuilder::combine(std::shared_ptr<INode> x, std::shared_ptr<INode> y, char op) const {
+        // Note: 0 * x is 0 even if x is NaN, it's fine for derivative, because NaN are also in source tree
+        switch (getOperatorTypeByChar(op)) {
+            case Operators::Plus:
+                if (isNumberEqual(x, 0.0)) {
+                    return y;
+                }
+
+                if (isNumberEqual(y, 0.0)) {
+                    return x;
+                }
+                break;
+            case Operators::Minus:
+                if (isNumberEqual(y, 0.0)) {
+                    return x;
+                }
+
+                if (isNumberEqual(x, 0.0)) {
+                    return createUnaryOperatorNode(std::move(y), '-');
+                }
+                break;
+            case Operators::Multiplication:
+                if (isNumberEqual(x, 0.0) || isNumberEqual(y, 0.0)) {
+                    return createNumberNode(0.0);
+                }
+
+                if (isNumberEqual(x, 1.0)) {
+                    return y;
+                }
+
+                if (isNumberEqual(y, 1.0)) {
+                    return x;
+                }
+                break;
+            case Operators::Division:
+                if (isNumberEqual(x, 0.0)) {
+                    return x;
+                }
+
+                if (isNumberEqual(y, 1.0)) {
+                    return x;
+                }
+                break;
+            default:
+                break;
+        }
+
+        return createOperatorNode(std::move(x), std::move(y), op);
+    }
+
+    inline std::shared_ptr<INode> ASTBuilder::createFunctionDerivative(std::string_view name, const std::shared_ptr<INode>& argument) const {
+        const auto call = [this, &argument](std::string_view functionName) -> std::shared_ptr<INode> {
+            const auto node = createFunctionNode(functionName);
+            node->argument = clone(argument);
+            return node;
+        };
+        const auto number = [this](double value) -> std::shared_ptr<INode> { return createNumberNode(value); };
+        const auto negate = [this](std::shared_ptr<INode> node) -> std::shared_ptr<INode> { return createUnaryOperatorNode(std::move(node), '-'); };
+        const auto square = [this, &call](std::string_view functionName) { return combine(call(functionName), call(functionName), '*'); };
+        const auto argumentSquare = [this, &argument]() { return combine(clone(argument), clone(argument), '*'); };
+
+        if (name == "sin") {
+            return call("cos");
+        } else if (name == "cos") {
+            return negate(call("sin"));
+        } else if (name == "tg") {
+            return combine(number(1.0), square("cos"), '/');
+        } else if (name == "ctg") {
+            return negate(combine(number(1.0), square("sin"), '/'));
+        } else if (name == "sh") {
+            return call("ch");
+        } else if (name == "ch") {
+            return call("sh");
+        } else if (name == "th") {
+            return combine(number(1.0), square("th"), '-');
+        } else if (name == "cth") {
+            return negate(combine(number(1.0), square("sh"), '/'));
+        } else if (name == "sch") {
+            return negate(combine(call("th"), call("sch"), '*'));
+        } else if (name == "csch") {
+            return negate(combine(call("cth"), call("csch"), '*'));
+        } else if (name == "arccos" || name == "arcsin") {
+            const auto root = createFunctionNode("sqrt");
+            root->argument = combine(number(1.0), argumentSquare(), '-');
+            const auto result = combine(number(1.0), root, '/');
+            return name == "arccos" ? negate(result) : result;
+        } else if (name == "arctg") {
+            return combine(number(1.0), combine(number(1.0), argumentSquare(), '+'), '/');
+        } else if (name == "arcctg") {
+            return negate(combine(number(1.0), combine(number(1.0), argumentSquare(), '+'), '/'));
+        } else if (name == "abs") {
+            return combine(call("abs"), clone(argument), '/');
+        } else if (name == "exp") {
+            return call("exp");
+        } else if (name == "sqrt") {
+            return combine(number(0.5), call("sqrt"), '/');
+        } else if (name == "norm") {
+            return combine(number(2.0), clone(argument), '*');
+        } else if (name == "ln") {
+            return combine(number(1.0), clone(argument), '/');
+        } else if (name == "log10") {
+            return combine(number(1.0), combine(clone(argument), number(std::numbers::ln10_v<double>), '*'), '/');
+        } else if (name == "log2") {
+            return combine(number(1.0), combine(clone(argument), number(std::numbers::ln2_v<double>), '*'), '/');
+        } else if (name == "arg" || name == "round") {
+            return number(0.0);
+        }
+
+        // Functions like fact and rnd
+        return nullptr;
+    }
+
+    inline std::shared_ptr<INode> ASTBuilder::derive(const std::shared_ptr<INode>& node, DerivativeVariable variable) const {
+        switch (node->getType()) {
+            case NodeTypes::Number:
+            case NodeTypes::ComplexNumber:
+                return createNumberNode(0.0);
+            case NodeTypes::Variable: {
+                // In real mode every variable except y and parameters is calculated as x
+                const auto variableNode = castToNodePtr<NodeTypes::Variable>(node);
+                const auto isY = variableNode->getValue() == 'y';
+                const auto isArgument = !variableNode->isParameter && (variable == DerivativeVariable::Y ? isY : !isY);
+                return createNumberNode(isArgument ? 1.0 : 0.0);
+            }
+            case NodeTypes::UnaryOperator: {
+                const auto unaryNode = castToNodePtr<NodeTypes::UnaryOperator>(node);
+                const auto child = derive(unaryNode->child, variable);
+                if (child == nullptr || getOperatorTypeByChar(unaryNode->operation) != Operators::Minus) {
+                    return child;
+                }
+
+                return combine(createNumberNode(0.0), child, '-');
+            }
+            case NodeTypes::Operator: {
+                const auto operatorNode = castToNodePtr<NodeTypes::Operator>(node);
+                const auto& left = operatorNode->left;
+                const auto& right = operatorNode->right;
+                const auto type = getOperatorTypeByChar(operatorNode->operation);
+                const auto rightDerivative = derive(right, variable);
+                // Equal returns right side, so left side is not matter
+                if (type == Operators::Equal || rightDerivative == nullptr) {
+                    return rightDerivative;
+                }
+
+                const auto leftDerivative = derive(left, variable);
+                if (leftDerivative == nullptr) {
+                    return nullptr;
+                }
+
+                switch (type) {
+                    case Operators::Plus:
+                    case Operators::Minus:
+                        return combine(leftDerivative, rightDerivative, operatorNode->operation);
+                    case Operators::Multiplication:
+                        return combine(combine(leftDerivative, clone(right), '*'), combine(clone(left), rightDerivative, '*'), '+');
+                    case Operators::Division: {
+                        const auto numerator = combine(combine(leftDerivative, clone(right), '*'), combine(clone(left), rightDerivative, '*'), '-');
+                        return combine(numerator, combine(clone(right), clone(right), '*'), '/');
+                    }
+                    case Operators::Power: {
+                        // Constant exponent: v * u^(v - 1) * u'
+                        if (isNumberEqual(rightDerivative, 0.0)) {
+                            const auto power = combine(clone(left), combine(clone(right), createNumberNode(1.0), '-'), '^');
+                            return combine(combine(clone(right), power, '*'), leftDerivative, '*');
+                        }
+
+                        // u^v * (v' * ln(u) + v * u' / u)
+                        const auto logarithm = createFunctionNode("ln");
+                        logarithm->argument = clone(left);
+                        const auto sum = combine(combine(rightDerivative, logarithm, '*'), 
+                            combine(combine(clone(right), leftDerivative, '*'), clone(left), '/'), '+');
+                        return combine(clone(node), sum, '*');
+                    }
+                    case Operators::Module:
+                        // We don't have floor function to express it for variable divisor
+                        return isNumberEqual(rightDerivative, 0.0) ? leftDerivative : nullptr;
+                    default:
+                        return nullptr;
+                }
+            }
+            case NodeTypes::Function: {
+                const auto functionNode = castToNodePtr<NodeTypes::Function>(node);
+                const auto argument = derive(functionNode->argument, variable);
+                if (argument == nullptr || isNumberEqual(argument, 0.0)) {
+                    return argument;
+                }
+
+                const auto function = createFunctionDerivative(functionNode->name, functionNode->argument);
+                if (function == nullptr) {
+                    KUB_WARN("function {} doesn't have derivative", functionNode->name);
+                    return nullptr;
+                }
+
+                return combine(function, argument, '*');
+            }
+            case NodeTypes::Root:
+                return derive(castToNodePtr<NodeTypes::Root>(node)->child, variable);
+            default:
+                return nullptr;
+        }
+    }
+
+    inline std::shared_ptr<INode> ASTBuilder::differentiate(const std::shared_ptr<INode>& node, DerivativeVariable variable) const {
+        if (node == nullptr) {
+            return nullptr;
+        }
+
+        // Derivative tree is built only from new nodes, so simplify can change them
+        const auto derivative = derive(node, variable);
+        return derivative == nullptr ? nullptr : simplify(derivative);
+    }
+
+    inline bool ASTBuilder::buildDerivative(ASTree& tree, const ASTree& source, const math::VariableDependenceController& vdc, DerivativeVariable variable) const {
+        tree.clear();
+        const auto derivative = differentiate(source.getRoot(), variable);
+        if (derivative == nullptr) {
+            return false;
+        }
+
+        // Derivatives have a lot of same subtrees after product rule
+        NodeTable table { };
+        tree.setRoot(createRoot(merge(derivative, table, vdc)));
+        return tree.validate();
+    }
+
+    inline void ASTBuilder::findVariables(const std::shared_ptr<INode>& node, bool& hasX, bool& hasY) const {
+        if (node == nullptr || (hasX && hasY)) {
+            return;
+        }
+
+        switch (node->getType()) {
+            case NodeTypes::Variable: {
+                const auto variableNode = castToNodePtr<NodeTypes::Variable>(node);
+                if (!variableNode->isParameter) {
+                    (variableNode->getValue() == 'y' ? hasY : hasX) = true;
+                }
+                break;
+            }
+            case NodeTypes::Operator: {
+                const auto operatorNode = castToNodePtr<NodeTypes::Operator>(node);
+                findVariables(operatorNode->left, hasX, hasY);
+                findVariables(operatorNode->right, hasX, hasY);
+                break;
+            }
+            case NodeTypes::UnaryOperator:
+                findVariables(castToNodePtr<NodeTypes::UnaryOperator>(node)->child, hasX, hasY);
+                break;
+            case NodeTypes::Function:
+                findVariables(castToNodePtr<NodeTypes::Function>(node)->argument, hasX, hasY);
+                break;
+            case NodeTypes::Root:
+                findVariables(castToNodePtr<NodeTypes::Root>(node)->child, hasX, hasY);
+                break;
+            default:
+                break;
+        }
+    }
+
+    inline math::VDC::ExpressionForm ASTBuilder::classify(const std::shared_ptr<INode>& node, const math::VDC& vdc) const {
+        // Equal returns its right side, so left side doesn't change value of expression 
+        auto valueNode = node;
+        while (valueNode != nullptr && valueNode->getType() == NodeTypes::Operator) {
+            const auto operatorNode = castToNodePtr<NodeTypes::Operator>(valueNode);
+            if (getOperatorTypeByChar(operatorNode->operation) != Operators::Equal) {
+                break;
+            }
+
+            valueNode = operatorNode->right;
+        }
+
+        auto hasX = false;
+        auto hasY = false;
+        findVariables(valueNode, hasX, hasY);
+
+        // Same rule as in expression, y is solved if left side is empty or it's y
+        const auto left = vdc.getVariableAtSide(math::VDC::VariableSide::Left);
+        const auto isYSolved = !left.has_value() || left.value().value == 'y';
+        if (isYSolved && !hasY) {
+            return math::VDC::ExpressionForm::ExplicitX;
+        }
+
+        if (!isYSolved && !hasX) {
+            return math::VDC::ExpressionForm::ExplicitY;
+        }
+
+        return math::VDC::ExpressionForm::Implicit;
+    }
+
     static constexpr std::initializer_list<char> RESERVED_VALUES = { 'x', 'y', 'z', 'w' };
 
     inline bool ASTBuilder::build(ASTree& tree, math::VariableDependenceController& vdc, const std::vector<Token>& tokens) {
@@ -106,11 +707,7 @@ namespace kubvc::algorithm {
             
             switch (token.type) {
                 case Token::Types::Number: {
-                    const auto value = token.value;
-                    double numberValue = 0.0;
-                    const auto result = std::from_chars(value.data(), value.data() + value.size(), numberValue).ec;
-                    KUB_ASSERT(result == std::errc(), "Invalid convert");
-                    const auto node = createNumberNode(numberValue);
+                    const auto node = createNumberNode(token.number);
                     nodeStack.push(node);
                     break;
                 }
@@ -170,6 +767,11 @@ namespace kubvc::algorithm {
                     const auto value = token.value;
                     // TODO: Args support, actually our function node is not supporting for multiple arguments
                     const auto node = createFunctionNode(value);
+                    if (node->realFunction == nullptr && node->complexFunction == nullptr) {
+                        KUB_ERROR("unknown function {}", value);
+                        return false;
+                    }
+
                     node->argument = nodeStack.top();
                     nodeStack.pop();
                     nodeStack.push(node);
@@ -228,8 +830,10 @@ namespace kubvc::algorithm {
             }
         }
 
-        const auto rootChildNode = nodeStack.top();
+        NodeTable table { };
+        const auto rootChildNode = merge(simplify(nodeStack.top()), table, vdc);
         KUB_ASSERT(rootChildNode != nullptr, "Child for root is nullptr");
+        vdc.setExpressionForm(classify(rootChildNode, vdc));
         const auto root = createRoot(rootChildNode);
         tree.setRoot(root);
         nodeStack.pop();
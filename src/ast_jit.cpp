@@ -0,0 +1,426 @@
+#include "ast_jit.h"
+#include "ast_program.h"
+#include "operators.h"
+#include "logger.h"
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define KUB_JIT_X86_64
+    #ifdef _WIN32
+        #define WIN32_LEAN_AND_MEAN
+        #define NOMINMAX
+        #include <windows.h>
+    #else
+        #include <sys/mman.h>
+    #endif
+#endif
+
+namespace kubvc::algorithm {
+#ifdef KUB_JIT_X86_64
+    namespace {
+        enum Register : std::uint8_t { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+        enum XmmRegister : std::uint8_t { XMM0, XMM1 };
+
+        // Memory operand [base + displacement] or [base + index * 8 + displacement]
+        struct Memory {
+            Register base = RAX;
+            std::int32_t displacement = 0;
+            bool hasIndex = false;
+            Register index = RAX;
+        };
+
+        // Minimal x86-64 encoder, it's supports only instructions which are used by code generator
+        class Assembler {
+            public:
+                using Label = std::size_t;
+
+                [[nodiscard]] const std::vector<std::uint8_t>& getCode() const { return m_code; }
+                [[nodiscard]] std::size_t getPosition() const { return m_code.size(); }
+
+                void push(Register reg) { rex(false, 0, 0, reg); emit(0x50 + (reg & 7)); }
+                void pop(Register reg) { rex(false, 0, 0, reg); emit(0x58 + (reg & 7)); }
+                void ret() { emit(0xC3); }
+
+                void mov(Register destination, Register source) { rex(true, source, 0, destination); emit(0x89); modrm(3, source, destination); }
+                void mov(Register destination, std::uint64_t immediate) { rex(true, 0, 0, destination); emit(0xB8 + (destination & 7)); emit64(immediate); }
+                void mov(Register destination, const Memory& source) { rex(true, destination, source); emit(0x8B); memory(destination, source); }
+                void mov(const Memory& destination, Register source) { rex(true, source, destination); emit(0x89); memory(source, destination); }
+
+                void movsd(XmmRegister destination, const Memory& source) { sse(0xF2, 0x10, destination, source); }
+                void movsd(const Memory& destination, XmmRegister source) { sse(0xF2, 0x11, source, destination); }
+                void addsd(XmmRegister destination, const Memory& source) { sse(0xF2, 0x58, destination, source); }
+                void mulsd(XmmRegister destination, const Memory& source) { sse(0xF2, 0x59, destination, source); }
+                void subsd(XmmRegister destination, const Memory& source) { sse(0xF2, 0x5C, destination, source); }
+                void divsd(XmmRegister destination, const Memory& source) { sse(0xF2, 0x5E, destination, source); }
+                void cvtss2sd(XmmRegister destination, const Memory& source) { sse(0xF3, 0x5A, destination, source); }
+
+                void subRsp(std::int32_t value) { rex(true, 0, 0, RSP); emit(0x81); modrm(3, 5, RSP); emit32(value); }
+                void addRsp(std::int32_t value) { rex(true, 0, 0, RSP); emit(0x81); modrm(3, 0, RSP); emit32(value); }
+                void xorSelf(Register reg) { rex(true, reg, 0, reg); emit(0x31); modrm(3, reg, reg); }
+                void cmp(Register left, Register right) { rex(true, right, 0, left); emit(0x39); modrm(3, right, left); }
+                void inc(Register reg) { rex(true, 0, 0, reg); emit(0xFF); modrm(3, 0, reg); }
+                // Bit test and reset/complement, used for sign bit
+                void btr(Register reg, std::uint8_t bit) { rex(true, 0, 0, reg); emit(0x0F); emit(0xBA); modrm(3, 6, reg); emit(bit); }
+                void btc(Register reg, std::uint8_t bit) { rex(true, 0, 0, reg); emit(0x0F); emit(0xBA); modrm(3, 7, reg); emit(bit); }
+                void call(Register reg) { rex(false, 0, 0, reg); emit(0xFF); modrm(3, 2, reg); }
+
+                // Forward jump, target is set by bind
+                [[nodiscard]] Label jae() { emit(0x0F); emit(0x83); return placeholder(); }
+
+                void bind(Label label) {
+                    const auto offset = static_cast<std::int32_t>(getPosition() - (label + sizeof(std::int32_t)));
+                    std::memcpy(m_code.data() + label, &offset, sizeof(offset));
+                }
+
+                // Backward jump to known position
+                void jmpTo(std::size_t target) {
+                    emit(0xE9);
+                    emit32(static_cast<std::int32_t>(target - (getPosition() + sizeof(std::int32_t))));
+                }
+
+            private:
+                void emit(std::uint8_t byte) { m_code.push_back(byte); }
+
+                void emit32(std::int32_t value) {
+                    for (std::size_t i = 0; i < sizeof(value); ++i) {
+                        emit(static_cast<std::uint8_t>(static_cast<std::uint32_t>(value) >> (i * 8)));
+                    }
+                }
+
+                void emit64(std::uint64_t value) {
+                    for (std::size_t i = 0; i < sizeof(value); ++i) {
+                        emit(static_cast<std::uint8_t>(value >> (i * 8)));
+                    }
+                }
+
+                Label placeholder() {
+                    const auto label = getPosition();
+                    emit32(0);
+                    return label;
+                }
+
+                void modrm(std::uint8_t mod, std::uint8_t reg, std::uint8_t rm) {
+                    emit(static_cast<std::uint8_t>((mod << 6) | ((reg & 7) << 3) | (rm & 7)));
+                }
+
+                // REX prefix is emitted only when it's needed
+                void rex(bool wide, std::uint8_t reg, std::uint8_t index, std::uint8_t base) {
+                    const auto prefix = static_cast<std::uint8_t>(0x40 | (wide << 3) | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3));
+                    if (prefix != 0x40) {
+                        emit(prefix);
+                    }
+                }
+
+                void rex(bool wide, std::uint8_t reg, const Memory& operand) {
+                    rex(wide, reg, operand.hasIndex ? operand.index : 0, operand.base);
+                }
+
+                // Always use 32-bit displacement, so rbp and r13 are not special cases
+                void memory(std::uint8_t reg, const Memory& operand) {
+                    if (operand.hasIndex) {
+                        modrm(2, reg, 4);
+                        emit(static_cast<std::uint8_t>((3 << 6) | ((operand.index & 7) << 3) | (operand.base & 7)));
+                    } else if ((operand.base & 7) == RSP) {
+                        modrm(2, reg, 4);
+                        emit(static_cast<std::uint8_t>((4 << 3) | (operand.base & 7)));
+                    } else {
+                        modrm(2, reg, operand.base);
+                    }
+
+                    emit32(operand.displacement);
+                }
+
+                void sse(std::uint8_t prefix, std::uint8_t opcode, std::uint8_t reg, const Memory& operand) {
+                    emit(prefix);
+                    rex(false, reg, operand);
+                    emit(0x0F);
+                    emit(opcode);
+                    memory(reg, operand);
+                }
+
+                std::vector<std::uint8_t> m_code;
+        };
+
+#ifdef _WIN32
+        constexpr Register ARGUMENT_REGISTERS[] = { RCX, RDX, R8, R9 };
+#else
+        constexpr Register ARGUMENT_REGISTERS[] = { RDI, RSI, RDX, RCX };
+#endif
+        constexpr Register CALLEE_SAVED_REGISTERS[] = { RBX, RBP, R12, R13, R14, R15 };
+        // Win64 requires space for four arguments of called function, on System V it's just unused
+        constexpr std::int32_t SHADOW_SPACE_SIZE = 32;
+
+        // Registers which are kept during whole sample loop
+        constexpr Register XS_BASE = RBX;
+        constexpr Register YS_BASE = R12;
+        constexpr Register OUT_BASE = R13;
+        constexpr Register COUNT_REGISTER = R14;
+        constexpr Register INDEX_REGISTER = R15;
+        constexpr Register PARAMETERS_BASE = RBP;
+
+        constexpr std::uint64_t NAN_BITS = std::bit_cast<std::uint64_t>(std::numeric_limits<double>::quiet_NaN());
+        constexpr std::uint64_t MIN_DIVISOR_BITS = std::bit_cast<std::uint64_t>(std::numeric_limits<double>::min());
+
+        // Module and power are calculated by same functions as in interpreter
+        double calculateModule(double left, double right) {
+            return calculateOperator(Operators::Module, left, right);
+        }
+
+        double calculatePower(double left, double right) {
+            return calculateOperator(Operators::Power, left, right);
+        }
+
+        template<typename T>
+        std::uint64_t getAddress(T* pointer) {
+            return static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(pointer));
+        }
+
+        void* allocateMemory(std::size_t size) {
+#ifdef _WIN32
+            return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+            const auto memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            return memory == MAP_FAILED ? nullptr : memory;
+#endif
+        }
+
+        // Memory is never writable and executable at same time
+        bool makeExecutable(void* memory, std::size_t size) {
+#ifdef _WIN32
+            DWORD oldProtect = 0;
+            return VirtualProtect(memory, size, PAGE_EXECUTE_READ, &oldProtect) != 0 &&
+                FlushInstructionCache(GetCurrentProcess(), memory, size) != 0;
+#else
+            return mprotect(memory, size, PROT_READ | PROT_EXEC) == 0;
+#endif
+        }
+
+        void releaseMemory(void* memory, [[maybe_unused]] std::size_t size) {
+#ifdef _WIN32
+            VirtualFree(memory, 0, MEM_RELEASE);
+#else
+            munmap(memory, size);
+#endif
+        }
+    }
+
+    NativeProgram::~NativeProgram() {
+        if (m_memory != nullptr) {
+            releaseMemory(m_memory, m_memorySize);
+        }
+    }
+
+    bool NativeProgram::isSupported() {
+        return true;
+    }
+
+    std::unique_ptr<NativeProgram> NativeProgram::compile(const Program& program) {
+        const auto instructions = program.getInstructions();
+        if (instructions.empty()) {
+            return nullptr;
+        }
+
+        auto native = std::unique_ptr<NativeProgram>(new NativeProgram());
+        // Slot table must have final size before we are take its address
+        std::size_t parametersCount = 0;
+        for (const auto& instruction : instructions) {
+            if (instruction.opcode == OpCodes::Parameter) {
+                ++parametersCount;
+            }
+        }
+        native->m_parameterSlots.reserve(parametersCount);
+
+        // Stack is aligned to 16 bytes at every call: return address + pushed registers + frame
+        // Temporary slots of shared values are placed after value stack
+        const auto temporaryBase = program.getStackDepth();
+        const auto slotsSize = SHADOW_SPACE_SIZE + static_cast<std::int32_t>((temporaryBase + program.getSlotCount()) * sizeof(double));
+        const auto frameSize = ((slotsSize + 15) & ~15) + 8;
+        const auto slot = [](std::size_t index) {
+            return Memory { .base = RSP, .displacement = SHADOW_SPACE_SIZE + static_cast<std::int32_t>(index * sizeof(double)) };
+        };
+        const auto sample = [](Register base) {
+            return Memory { .base = base, .hasIndex = true, .index = INDEX_REGISTER };
+        };
+
+        Assembler assembler;
+        for (const auto reg : CALLEE_SAVED_REGISTERS) {
+            assembler.push(reg);
+        }
+        assembler.subRsp(frameSize);
+        assembler.mov(XS_BASE, ARGUMENT_REGISTERS[0]);
+        assembler.mov(YS_BASE, ARGUMENT_REGISTERS[1]);
+        assembler.mov(OUT_BASE, ARGUMENT_REGISTERS[2]);
+        assembler.mov(COUNT_REGISTER, ARGUMENT_REGISTERS[3]);
+        assembler.mov(PARAMETERS_BASE, getAddress(native->m_parameterSlots.data()));
+        assembler.xorSelf(INDEX_REGISTER);
+
+        const auto loopStart = assembler.getPosition();
+        assembler.cmp(INDEX_REGISTER, COUNT_REGISTER);
+        const auto loopEnd = assembler.jae();
+
+        std::size_t top = 0;
+        const auto binary = [&assembler, &slot, &top](auto emitOperation) {
+            --top;
+            assembler.movsd(XMM0, slot(top - 1));
+            emitOperation(slot(top));
+            assembler.movsd(slot(top - 1), XMM0);
+        };
+        const auto callBinary = [&assembler, &slot, &top](double (*function)(double, double)) {
+            --top;
+            assembler.movsd(XMM0, slot(top - 1));
+            assembler.movsd(XMM1, slot(top));
+            assembler.mov(RAX, getAddress(function));
+            assembler.call(RAX);
+            assembler.movsd(slot(top - 1), XMM0);
+        };
+
+        for (const auto& instruction : instructions) {
+            switch (instruction.opcode) {
+                case OpCodes::Number:
+                    assembler.mov(RAX, std::bit_cast<std::uint64_t>(instruction.immediate.real()));
+                    assembler.mov(slot(top++), RAX);
+                    break;
+                case OpCodes::VariableY:
+                    assembler.movsd(XMM0, sample(YS_BASE));
+                    assembler.movsd(slot(top++), XMM0);
+                    break;
+                case OpCodes::VariableX:
+                case OpCodes::VariableZ:
+                case OpCodes::VariableOther:
+                    assembler.movsd(XMM0, sample(XS_BASE));
+                    assembler.movsd(slot(top++), XMM0);
+                    break;
+                case OpCodes::Parameter: {
+                    const auto parameterIndex = native->m_parameterSlots.size();
+                    native->m_parameterSlots.push_back(instruction.parameter);
+                    assembler.mov(RAX, Memory { .base = PARAMETERS_BASE, .displacement = static_cast<std::int32_t>(parameterIndex * sizeof(const float*)) });
+                    assembler.cvtss2sd(XMM0, Memory { .base = RAX });
+                    assembler.movsd(slot(top++), XMM0);
+                    break;
+                }
+                // Complex numbers can't be used in real mode calculation
+                case OpCodes::ComplexNumber:
+                case OpCodes::Invalid:
+                    assembler.mov(RAX, NAN_BITS);
+                    assembler.mov(slot(top++), RAX);
+                    break;
+                case OpCodes::Add:
+                    binary([&assembler](const Memory& right) { assembler.addsd(XMM0, right); });
+                    break;
+                case OpCodes::Subtract:
+                    binary([&assembler](const Memory& right) { assembler.subsd(XMM0, right); });
+                    break;
+                case OpCodes::Multiply:
+                    binary([&assembler](const Memory& right) { assembler.mulsd(XMM0, right); });
+                    break;
+                case OpCodes::Divide: {
+                    binary([&assembler](const Memory& right) { assembler.divsd(XMM0, right); });
+                    // If divisor is too close to zero we are set result as NaN,
+                    // bits of positive doubles are ordered same as values, NaN is greater than any of them
+                    assembler.mov(RAX, slot(top));
+                    assembler.btr(RAX, 63);
+                    assembler.mov(RCX, MIN_DIVISOR_BITS);
+                    assembler.cmp(RAX, RCX);
+                    const auto skip = assembler.jae();
+                    assembler.mov(RAX, NAN_BITS);
+                    assembler.mov(slot(top - 1), RAX);
+                    assembler.bind(skip);
+                    break;
+                }
+                case OpCodes::Module:
+                    callBinary(&calculateModule);
+                    break;
+                case OpCodes::Power:
+                    callBinary(&calculatePower);
+                    break;
+                case OpCodes::Equal:
+                    --top;
+                    assembler.mov(RAX, slot(top));
+                    assembler.mov(slot(top - 1), RAX);
+                    break;
+                case OpCodes::Negate:
+                    assembler.mov(RAX, slot(top - 1));
+                    assembler.btc(RAX, 63);
+                    assembler.mov(slot(top - 1), RAX);
+                    break;
+                case OpCodes::Function: {
+                    if (instruction.realFunction == nullptr) {
+                        assembler.mov(RAX, NAN_BITS);
+                        assembler.mov(slot(top - 1), RAX);
+                        break;
+                    }
+
+                    assembler.movsd(XMM0, slot(top - 1));
+                    assembler.mov(RAX, getAddress(instruction.realFunction.get()));
+                    assembler.call(RAX);
+                    assembler.movsd(slot(top - 1), XMM0);
+                    break;
+                }
+                case OpCodes::Store:
+                    assembler.mov(RAX, slot(top - 1));
+                    assembler.mov(slot(temporaryBase + instruction.slot), RAX);
+                    break;
+                case OpCodes::Load:
+                    assembler.mov(RAX, slot(temporaryBase + instruction.slot));
+                    assembler.mov(slot(top++), RAX);
+                    break;
+                default:
+                    KUB_ERROR("jit: unsupported opcode {}", static_cast<std::int32_t>(instruction.opcode));
+                    return nullptr;
+            }
+        }
+
+        if (top != 1) {
+            KUB_ERROR("jit: invalid stack depth {} at program end", top);
+            return nullptr;
+        }
+
+        assembler.movsd(XMM0, slot(0));
+        assembler.movsd(sample(OUT_BASE), XMM0);
+        assembler.inc(INDEX_REGISTER);
+        assembler.jmpTo(loopStart);
+        assembler.bind(loopEnd);
+
+        assembler.addRsp(frameSize);
+        for (auto it = std::rbegin(CALLEE_SAVED_REGISTERS); it != std::rend(CALLEE_SAVED_REGISTERS); ++it) {
+            assembler.pop(*it);
+        }
+        assembler.ret();
+
+        static constexpr std::size_t MEMORY_PAGE_SIZE = 4096;
+        const auto& code = assembler.getCode();
+        native->m_codeSize = code.size();
+        native->m_memorySize = (code.size() + MEMORY_PAGE_SIZE - 1) / MEMORY_PAGE_SIZE * MEMORY_PAGE_SIZE;
+        native->m_memory = allocateMemory(native->m_memorySize);
+        if (native->m_memory == nullptr) {
+            KUB_ERROR("jit: failed to allocate {} bytes", native->m_memorySize);
+            return nullptr;
+        }
+
+        std::memcpy(native->m_memory, code.data(), code.size());
+        if (!makeExecutable(native->m_memory, native->m_memorySize)) {
+            KUB_ERROR("jit: failed to make memory executable");
+            return nullptr;
+        }
+
+        native->m_entryPoint = reinterpret_cast<EntryPoint>(native->m_memory);
+        KUB_DEBUG("jit: compiled {} instructions to {} bytes", instructions.size(), native->m_codeSize);
+        return native;
+    }
+#else
+    NativeProgram::~NativeProgram() { }
+
+    bool NativeProgram::isSupported() {
+        return false;
+    }
+
+    std::unique_ptr<NativeProgram> NativeProgram::compile([[maybe_unused]] const Program& program) {
+        return nullptr;
+    }
+#endif
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace kubvc::algorithm {
+    class Program;
+
+    // Native x86-64 machine code generated from program, it's used only for real mode calculations.
+    // Value stack lives in native stack frame, parameters are loaded from slot table
+    // and functions are called directly by their handlers
+    class NativeProgram {
+        public:
+            using EntryPoint = void(*)(const double* xs, const double* ys, double* out, std::size_t count);
+
+            NativeProgram(const NativeProgram&) = delete;
+            NativeProgram(NativeProgram&&) = delete;
+            NativeProgram& operator=(const NativeProgram&) = delete;
+            NativeProgram& operator=(NativeProgram&&) = delete;
+            ~NativeProgram();
+
+            // Emit machine code for program, returns nullptr if platform isn't supported or code can't be emitted
+            [[nodiscard]] static std::unique_ptr<NativeProgram> compile(const Program& program);
+
+            // Is current platform supported by code generator
+            [[nodiscard]] static bool isSupported();
+
+            // Calculate for each pair of xs and ys, all arrays must have count elements
+            void calculate(const double* xs, const double* ys, double* out, std::size_t count) const {
+                m_entryPoint(xs, ys, out, count);
+            }
+
+            [[nodiscard]] std::size_t getCodeSize() const { return m_codeSize; }
+
+        private:
+            NativeProgram() = default;
+
+            // Executable memory with generated code
+            void* m_memory = nullptr;
+            std::size_t m_memorySize = 0;
+            std::size_t m_codeSize = 0;
+            EntryPoint m_entryPoint = nullptr;
+            // Generated code loads parameter pointers from this table, so it must not be resized after compile
+            std::vector<const float*> m_parameterSlots;
+    };
+}
@@ -1,5 +1,7 @@
 #pragma once 
 #include "nodeTypes.h"
+#include "math_base.h"
+#include "interval.h"
 #include <memory>
 #include <string>
 #include <cstdint>
@@ -122,6 +124,12 @@ namespace kubvc::algorithm {
         
         std::string name;
         std::shared_ptr<INode> argument;
+        // Handlers are bound once by builder, so calculation doesn't search function by name
+        math::containers::RealFunctionHandler realFunction = nullptr;
+        math::containers::ComplexFunctionHandler complexFunction = nullptr;
+        // Derivative of real function, it's nullptr if function doesn't have it 
+        math::containers::RealFunctionHandler realDerivative = nullptr;
+        math::containers::IntervalFunctionHandler intervalFunction = nullptr;
     };
 
     [[nodiscard]] inline static constexpr std::string_view getNodeName(kubvc::algorithm::NodeTypes type) {
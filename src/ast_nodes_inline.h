@@ -32,7 +32,11 @@ namespace kubvc::algorithm {
 
     inline double NodeTraits<NodeTypes::Function>::calculate(double x, [[maybe_unused]] double y) {
         // Same logic as root, ast will be push in x value result from child node 
-        return Helpers::computeFunction(name, x); 
+        if (realFunction == nullptr) {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+
+        return realFunction(x); 
     }
         
     inline double NodeTraits<NodeTypes::UnaryOperator>::calculate(double x, [[maybe_unused]] double y) {        
@@ -43,39 +47,12 @@ namespace kubvc::algorithm {
     inline double NodeTraits<NodeTypes::Operator>::calculate(double x, double y) {    
         // Same logic as root or unary, ast will be push in x, y values result from children nodes 
         const auto operatorType = getOperatorTypeByChar(operation);
-        switch(operatorType) {
-            case Operators::Equal: {
-                return y;
-            }
-            case Operators::Plus: {
-                return x + y;
-            }
-            case Operators::Minus: {
-                return x - y;
-            }
-            case Operators::Multiplication: {
-                return x * y;
-            }
-            case Operators::Division: {                
-                // If we are too close to zero we are set result as NaN
-                if (glm::abs(y) < std::numeric_limits<double>::min()) {  
-                    return std::numeric_limits<double>::quiet_NaN();
-                }
-                
-                return x / y;
-            }
-            case Operators::Module: {
-                return glm::mod(x, y);
-            }                        
-            case Operators::Power: {
-                return glm::pow(x, y);
-            }
-            default:
-                KUB_ERROR("Unknown type operator: {}", std::string(1, operation));
-                break;
-        }     
-
-        return std::numeric_limits<double>::quiet_NaN();         
+        if (operatorType == Operators::Unknown) {
+            KUB_ERROR("Unknown type operator: {}", std::string(1, operation));
+            return std::numeric_limits<double>::quiet_NaN();         
+        }
+
+        return calculateOperator(operatorType, x, y);
     }
         
     inline std::complex<double> NodeTraits<NodeTypes::Root>::calculateComplex(double re, double im) { 
@@ -125,47 +102,22 @@ namespace kubvc::algorithm {
 
     inline std::complex<double> NodeTraits<NodeTypes::Operator>::calculateComplexOperator(const std::complex<double>& leftNumber, const std::complex<double>& rightNumber) { 
         const auto operatorType = getOperatorTypeByChar(operation);
-        switch(operatorType) {
-            case Operators::Equal: {
-                return rightNumber;
-            }
-            case Operators::Plus: {
-                return leftNumber + rightNumber;
-            }
-            case Operators::Minus: {
-                return leftNumber - rightNumber;
-            }
-            case Operators::Multiplication: {
-                return leftNumber * rightNumber;
-            }
-            case Operators::Division: {                
-                // If we are too close to zero we are set result as NaN
-                if (std::abs(rightNumber) < std::numeric_limits<double>::min()) {  
-                    return { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN() }; 
-                }
-                
-                return leftNumber / rightNumber;
-            }
-            case Operators::Module: {
-                return {0.0, 0.0}; // TODO: 
-            }                        
-            case Operators::Power: {
-                return std::pow(leftNumber, rightNumber);
-            }
-            default: {
-                //KUB_ASSERT(false, "Unknown type operator: {}", std::string(1, operation));
-                KUB_ERROR("Unknown type operator: {}", std::string(1, operation));
-                break;
-            }
-        }  
+        if (operatorType == Operators::Unknown) {
+            KUB_ERROR("Unknown type operator: {}", std::string(1, operation));
+            return { 0.0, 0.0 };
+        }
 
-        return { 0.0, 0.0 };
+        return algorithm::calculateComplexOperator(operatorType, leftNumber, rightNumber);
     }
  
     inline std::complex<double> NodeTraits<NodeTypes::Function>::calculateComplex(double re, double im) { 
         KUB_ASSERT(argument != nullptr, "Argument is null in FunctionNode");
+        if (complexFunction == nullptr) {
+            return { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN() };
+        }
+
         const auto argumentResult = std::complex<double> { re, im };        
-        return Helpers::computeComplexFunction(name, argumentResult); 
+        return complexFunction(argumentResult); 
     }
 
 
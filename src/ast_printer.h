@@ -0,0 +1,79 @@
+#pragma once
+#include "ast_nodes.h"
+#include "operators.h"
+
+#include <array>
+#include <charconv>
+#include <optional>
+#include <string>
+
+namespace kubvc::algorithm {
+    // Print subtree as text which lexer can parse back to same tree. Every operator is wrapped in brackets,
+    // because lexer priorities are not same as usual math ones. Returns nothing if subtree can't be printed
+    [[nodiscard]] inline std::optional<std::string> printNode(const std::shared_ptr<INode>& node) {
+        if (node == nullptr) {
+            return std::nullopt;
+        }
+
+        switch (node->getType()) {
+            case NodeTypes::Number: {
+                const auto value = castToNodePtr<NodeTypes::Number>(node)->getValue();
+                if (!std::isfinite(value)) {
+                    return std::nullopt;
+                }
+
+                // Lexer knows only digits and dot, so we can't use exponent format here
+                std::array<char, 512> buffer { };
+                const auto [end, error] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), std::abs(value), std::chars_format::fixed);
+                if (error != std::errc()) {
+                    return std::nullopt;
+                }
+
+                const auto text = std::string(buffer.data(), end);
+                return value < 0.0 ? "(0-" + text + ")" : text;
+            }
+            case NodeTypes::ComplexNumber:
+                return "i";
+            case NodeTypes::Variable: {
+                // Variable is printed by its role, because lexer assigns roles again by order of variables in text.
+                // Every variable except y and parameters is calculated as x, parameters are never named as x or y
+                const auto variableNode = castToNodePtr<NodeTypes::Variable>(node);
+                const auto value = variableNode->getValue();
+                return std::string(1, variableNode->isParameter || value == 'y' ? value : 'x');
+            }
+            case NodeTypes::Operator: {
+                const auto operatorNode = castToNodePtr<NodeTypes::Operator>(node);
+                const auto left = printNode(operatorNode->left);
+                const auto right = printNode(operatorNode->right);
+                if (!left.has_value() || !right.has_value()) {
+                    return std::nullopt;
+                }
+
+                return "(" + left.value() + operatorNode->operation + right.value() + ")";
+            }
+            case NodeTypes::UnaryOperator: {
+                const auto unaryNode = castToNodePtr<NodeTypes::UnaryOperator>(node);
+                const auto child = printNode(unaryNode->child);
+                if (!child.has_value() || getOperatorTypeByChar(unaryNode->operation) != Operators::Minus) {
+                    return child;
+                }
+
+                // Unary operator before bracket is applied to whole rest of expression by lexer, so we are print it as subtraction
+                return "(0-" + child.value() + ")";
+            }
+            case NodeTypes::Function: {
+                const auto functionNode = castToNodePtr<NodeTypes::Function>(node);
+                const auto argument = printNode(functionNode->argument);
+                if (!argument.has_value()) {
+                    return std::nullopt;
+                }
+
+                return functionNode->name + "(" + argument.value() + ")";
+            }
+            case NodeTypes::Root:
+                return printNode(castToNodePtr<NodeTypes::Root>(node)->child);
+            default:
+                return std::nullopt;
+        }
+    }
+}
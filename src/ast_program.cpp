@@ -0,0 +1,844 @@
+#include "ast_program.h"
+#include "operators.h"
+#include "logger.h"
+#include "alg_helpers.h"
+
+#include <algorithm>
+#include <bit>
+#include <random>
+#include <unordered_map>
+
+namespace kubvc::algorithm {
+    static inline OpCodes getOperatorOpCode(char operation) {
+        switch (getOperatorTypeByChar(operation)) {
+            case Operators::Plus:
+                return OpCodes::Add;
+            case Operators::Minus:
+                return OpCodes::Subtract;
+            case Operators::Multiplication:
+                return OpCodes::Multiply;
+            case Operators::Division:
+                return OpCodes::Divide;
+            case Operators::Module:
+                return OpCodes::Module;
+            case Operators::Power:
+                return OpCodes::Power;
+            case Operators::Equal:
+                return OpCodes::Equal;
+            default:
+                break;
+        }
+
+        return OpCodes::Invalid;
+    }
+
+    static inline OpCodes getVariableOpCode(char variable) {
+        switch (variable) {
+            case 'x':
+                return OpCodes::VariableX;
+            case 'y':
+                return OpCodes::VariableY;
+            case 'z':
+                return OpCodes::VariableZ;
+        }
+
+        return OpCodes::VariableOther;
+    }
+
+    std::shared_ptr<const Program> Program::compile(std::span<const std::shared_ptr<INode>> nodes, bool useJit) {
+        if (nodes.empty()) {
+            return nullptr;
+        }
+
+        auto program = std::make_shared<Program>();
+        program->m_instructions.reserve(nodes.size());
+
+        // Track stack depth to check program once here instead of every calculation
+        std::size_t depth = 0;
+        const auto push = [&program, &depth](Instruction&& instruction) {
+            program->m_instructions.push_back(std::move(instruction));
+            program->m_stackDepth = std::max(program->m_stackDepth, ++depth);
+        };
+
+        // Shared node is met in list once with its subtree and then only as a reference
+        std::unordered_map<const INode*, std::size_t> usesCount;
+        for (const auto& node : nodes) {
+            ++usesCount[node.get()];
+        }
+        std::unordered_map<const INode*, std::uint32_t> slots;
+
+        for (const auto& node : nodes) {
+            const auto type = node->getType();
+            // Leaves are cheaper to push again than to load from slot
+            const auto isShared = usesCount[node.get()] > 1 && 
+                (type == NodeTypes::Operator || type == NodeTypes::UnaryOperator || type == NodeTypes::Function);
+            if (isShared) {
+                const auto it = slots.find(node.get());
+                if (it != slots.end()) {
+                    push({ .opcode = OpCodes::Load, .slot = it->second });
+                    continue;
+                }
+            }
+
+            switch (type) {
+                case NodeTypes::Number: {
+                    const auto numberNode = castToNodePtr<NodeTypes::Number>(node);
+                    push({ .opcode = OpCodes::Number, .immediate = { numberNode->getValue(), 0.0 } });
+                    break;
+                }
+                case NodeTypes::ComplexNumber: {
+                    const auto complexNode = castToNodePtr<NodeTypes::ComplexNumber>(node);
+                    push({ .opcode = OpCodes::ComplexNumber, .immediate = complexNode->getValue() });
+                    break;
+                }
+                case NodeTypes::Variable: {
+                    const auto variableNode = castToNodePtr<NodeTypes::Variable>(node);
+                    if (variableNode->isParameter) {
+                        push({ .opcode = OpCodes::Parameter, .parameter = &variableNode->parameter });
+                        program->m_nodes.push_back(node);
+                    } else {
+                        push({ .opcode = getVariableOpCode(variableNode->getValue()) });
+                    }
+                    break;
+                }
+                case NodeTypes::Invalid: {
+                    push({ .opcode = OpCodes::Invalid });
+                    break;
+                }
+                case NodeTypes::Operator: {
+                    if (depth < 2) {
+                        KUB_ERROR("program: stack underflow at Operator node");
+                        return nullptr;
+                    }
+
+                    const auto operatorNode = castToNodePtr<NodeTypes::Operator>(node);
+                    const auto opcode = getOperatorOpCode(operatorNode->operation);
+                    if (opcode == OpCodes::Invalid) {
+                        KUB_ERROR("program: unknown type operator: {}", std::string(1, operatorNode->operation));
+                        return nullptr;
+                    }
+
+                    program->m_instructions.push_back({ .opcode = opcode });
+                    --depth;
+                    break;
+                }
+                case NodeTypes::UnaryOperator: {
+                    if (depth == 0) {
+                        KUB_ERROR("program: stack underflow at unary node");
+                        return nullptr;
+                    }
+
+                    // Unary plus doesn't change anything, so we are skip it
+                    const auto unaryNode = castToNodePtr<NodeTypes::UnaryOperator>(node);
+                    if (getOperatorTypeByChar(unaryNode->operation) == Operators::Minus) {
+                        program->m_instructions.push_back({ .opcode = OpCodes::Negate });
+                    }
+                    break;
+                }
+                case NodeTypes::Function: {
+                    if (depth == 0) {
+                        KUB_ERROR("program: stack underflow at function node");
+                        return nullptr;
+                    }
+
+                    const auto functionNode = castToNodePtr<NodeTypes::Function>(node);
+                    program->m_instructions.push_back({
+                        .opcode = OpCodes::Function,
+                        .realFunction = functionNode->realFunction,
+                        .complexFunction = functionNode->complexFunction,
+                        .realDerivative = functionNode->realDerivative,
+                        .intervalFunction = functionNode->intervalFunction,
+                        .functionKernel = simd::getFunctionKernel(functionNode->name)
+                    });
+                    break;
+                }
+                // Root only returns result of child
+                case NodeTypes::Root:
+                case NodeTypes::None:
+                    break;
+                default: {
+                    KUB_ERROR("program: unknown node type {}", static_cast<std::int32_t>(node->getType()));
+                    return nullptr;
+                }
+            }
+
+            if (isShared) {
+                const auto slot = static_cast<std::uint32_t>(program->m_slotCount++);
+                slots.emplace(node.get(), slot);
+                program->m_instructions.push_back({ .opcode = OpCodes::Store, .slot = slot });
+            }
+        }
+
+        if (depth != 1) {
+            KUB_ERROR("program: invalid stack depth {} at program end", depth);
+            return nullptr;
+        }
+
+        if (program->m_stackDepth + program->m_slotCount > VALUE_STACK_SIZE) {
+            KUB_ERROR("program: stack depth {} and {} slots > value stack size", program->m_stackDepth, program->m_slotCount);
+            return nullptr;
+        }
+
+        for (const auto& instruction : program->m_instructions) {
+            auto& hash = program->m_hash;
+            hash = Helpers::combineHash(hash, static_cast<std::uint64_t>(instruction.opcode));
+            hash = Helpers::combineHash(hash, std::bit_cast<std::uint64_t>(instruction.immediate.real()));
+            hash = Helpers::combineHash(hash, std::bit_cast<std::uint64_t>(instruction.immediate.imag()));
+            // Functions are same for all programs, so their addresses are used
+            hash = Helpers::combineHash(hash, reinterpret_cast<std::uintptr_t>(instruction.realFunction.get()));
+            hash = Helpers::combineHash(hash, reinterpret_cast<std::uintptr_t>(instruction.complexFunction.get()));
+            hash = Helpers::combineHash(hash, instruction.slot);
+        }
+
+        if (useJit) {
+            program->m_native = NativeProgram::compile(*program);
+            if (program->m_native == nullptr) {
+                KUB_WARN("program: native code isn't available, interpreter is used");
+            }
+#ifdef KUB_IS_DEBUG
+            else if (!program->verifyNative()) {
+                program->m_native = nullptr;
+            }
+#endif
+        }
+
+        return program;
+    }
+
+    bool Program::verifyNative() const {
+        static constexpr std::size_t SAMPLES_COUNT = 256;
+        std::mt19937 generator(static_cast<std::uint32_t>(m_instructions.size()));
+        std::uniform_real_distribution<double> distribution(-100.0, 100.0);
+
+        std::vector<double> xs(SAMPLES_COUNT);
+        std::vector<double> ys(SAMPLES_COUNT);
+        std::vector<double> out(SAMPLES_COUNT);
+        for (std::size_t i = 0; i < SAMPLES_COUNT; ++i) {
+            xs[i] = distribution(generator);
+            ys[i] = distribution(generator);
+        }
+        // Check special cases like division by zero too
+        xs[0] = 0.0;
+        ys[0] = 0.0;
+        xs[1] = -0.0;
+        ys[1] = 1.0;
+
+        m_native->calculate(xs.data(), ys.data(), out.data(), SAMPLES_COUNT);
+        for (std::size_t i = 0; i < SAMPLES_COUNT; ++i) {
+            const auto expected = interpret(xs[i], ys[i]);
+            // Skip samples which are not deterministic, for example with random function
+            if (std::bit_cast<std::uint64_t>(expected) != std::bit_cast<std::uint64_t>(interpret(xs[i], ys[i]))) {
+                continue;
+            }
+
+            const auto isSame = (std::isnan(expected) && std::isnan(out[i])) || expected == out[i];
+            if (!isSame) {
+                KUB_ERROR("program: native code mismatch at x={} y={}, expected {} but got {}", xs[i], ys[i], expected, out[i]);
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    double Program::calculate(double x, double y) const {
+        if (m_native != nullptr) {
+            double result = 0.0;
+            m_native->calculate(&x, &y, &result, 1);
+            return result;
+        }
+
+        return interpret(x, y);
+    }
+
+    double Program::interpret(double x, double y) const {
+        thread_local static double valueStack[VALUE_STACK_SIZE];
+        // Temporary slots are placed right after value stack
+        const auto slots = valueStack + m_stackDepth;
+        std::size_t top = 0;
+        for (const auto& instruction : m_instructions) {
+            switch (instruction.opcode) {
+                case OpCodes::Number:
+                    valueStack[top++] = instruction.immediate.real();
+                    break;
+                case OpCodes::VariableY:
+                    valueStack[top++] = y;
+                    break;
+                case OpCodes::VariableX:
+                case OpCodes::VariableZ:
+                case OpCodes::VariableOther:
+                    valueStack[top++] = x;
+                    break;
+                case OpCodes::Parameter:
+                    valueStack[top++] = *instruction.parameter;
+                    break;
+                // Complex numbers can't be used in real mode calculation
+                case OpCodes::ComplexNumber:
+                case OpCodes::Invalid:
+                    valueStack[top++] = std::numeric_limits<double>::quiet_NaN();
+                    break;
+                case OpCodes::Add: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateOperator(Operators::Plus, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Subtract: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateOperator(Operators::Minus, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Multiply: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateOperator(Operators::Multiplication, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Divide: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateOperator(Operators::Division, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Module: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateOperator(Operators::Module, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Power: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateOperator(Operators::Power, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Equal: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = right;
+                    break;
+                }
+                case OpCodes::Negate:
+                    valueStack[top - 1] = -valueStack[top - 1];
+                    break;
+                case OpCodes::Function: {
+                    const auto argument = valueStack[top - 1];
+                    valueStack[top - 1] = instruction.realFunction == nullptr ?
+                        std::numeric_limits<double>::quiet_NaN() : instruction.realFunction(argument);
+                    break;
+                }
+                case OpCodes::Store:
+                    slots[instruction.slot] = valueStack[top - 1];
+                    break;
+                case OpCodes::Load:
+                    valueStack[top++] = slots[instruction.slot];
+                    break;
+            }
+        }
+
+        return top == 0 ? std::numeric_limits<double>::quiet_NaN() : valueStack[top - 1];
+    }
+
+    std::complex<double> Program::calculateComplex(double re, double im) const {
+        constexpr auto NaN = std::numeric_limits<double>::quiet_NaN();
+        thread_local static std::complex<double> valueStack[VALUE_STACK_SIZE];
+        const auto slots = valueStack + m_stackDepth;
+        std::size_t top = 0;
+        for (const auto& instruction : m_instructions) {
+            switch (instruction.opcode) {
+                case OpCodes::Number:
+                case OpCodes::ComplexNumber:
+                    valueStack[top++] = instruction.immediate;
+                    break;
+                case OpCodes::VariableZ:
+                    valueStack[top++] = { re, im };
+                    break;
+                case OpCodes::VariableX:
+                case OpCodes::VariableY:
+                    valueStack[top++] = { re, 0.0 };
+                    break;
+                case OpCodes::VariableOther:
+                    valueStack[top++] = { 0.0, 0.0 };
+                    break;
+                case OpCodes::Parameter:
+                    valueStack[top++] = { *instruction.parameter, 0.0 };
+                    break;
+                case OpCodes::Invalid:
+                    valueStack[top++] = { NaN, NaN };
+                    break;
+                case OpCodes::Add: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateComplexOperator(Operators::Plus, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Subtract: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateComplexOperator(Operators::Minus, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Multiply: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateComplexOperator(Operators::Multiplication, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Divide: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateComplexOperator(Operators::Division, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Module: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateComplexOperator(Operators::Module, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Power: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateComplexOperator(Operators::Power, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Equal: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = right;
+                    break;
+                }
+                case OpCodes::Negate:
+                    valueStack[top - 1] = -valueStack[top - 1];
+                    break;
+                case OpCodes::Function: {
+                    const auto argument = valueStack[top - 1];
+                    valueStack[top - 1] = instruction.complexFunction == nullptr ?
+                        std::complex<double> { NaN, NaN } : instruction.complexFunction(argument);
+                    break;
+                }
+                case OpCodes::Store:
+                    slots[instruction.slot] = valueStack[top - 1];
+                    break;
+                case OpCodes::Load:
+                    valueStack[top++] = slots[instruction.slot];
+                    break;
+            }
+        }
+
+        return top == 0 ? std::complex<double> { NaN, NaN } : valueStack[top - 1];
+    }
+
+    math::Dual Program::calculateDual(double x, double y, DerivativeVariable variable) const {
+        constexpr auto NaN = std::numeric_limits<double>::quiet_NaN();
+        thread_local static math::Dual valueStack[VALUE_STACK_SIZE];
+        const auto slots = valueStack + m_stackDepth;
+        const math::Dual dx = { x, variable == DerivativeVariable::X ? 1.0 : 0.0 };
+        const math::Dual dy = { y, variable == DerivativeVariable::Y ? 1.0 : 0.0 };
+        std::size_t top = 0;
+        for (const auto& instruction : m_instructions) {
+            switch (instruction.opcode) {
+                case OpCodes::Number:
+                    valueStack[top++] = { instruction.immediate.real(), 0.0 };
+                    break;
+                case OpCodes::VariableY:
+                    valueStack[top++] = dy;
+                    break;
+                case OpCodes::VariableX:
+                case OpCodes::VariableZ:
+                case OpCodes::VariableOther:
+                    valueStack[top++] = dx;
+                    break;
+                case OpCodes::Parameter:
+                    valueStack[top++] = { *instruction.parameter, 0.0 };
+                    break;
+                case OpCodes::ComplexNumber:
+                case OpCodes::Invalid:
+                    valueStack[top++] = { NaN, NaN };
+                    break;
+                case OpCodes::Add: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateDualOperator(Operators::Plus, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Subtract: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateDualOperator(Operators::Minus, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Multiply: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateDualOperator(Operators::Multiplication, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Divide: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateDualOperator(Operators::Division, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Module: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateDualOperator(Operators::Module, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Power: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateDualOperator(Operators::Power, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Equal: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = right;
+                    break;
+                }
+                case OpCodes::Negate:
+                    valueStack[top - 1] = -valueStack[top - 1];
+                    break;
+                case OpCodes::Function: {
+                    // Chain rule: f(u)' = f'(u) * u'
+                    const auto argument = valueStack[top - 1];
+                    if (instruction.realFunction == nullptr) {
+                        valueStack[top - 1] = { NaN, NaN };
+                        break;
+                    }
+
+                    auto derivative = 0.0;
+                    if (argument.derivative != 0.0) {
+                        derivative = instruction.realDerivative == nullptr ? NaN : 
+                            instruction.realDerivative(argument.value) * argument.derivative;
+                    }
+                    valueStack[top - 1] = { instruction.realFunction(argument.value), derivative };
+                    break;
+                }
+                case OpCodes::Store:
+                    slots[instruction.slot] = valueStack[top - 1];
+                    break;
+                case OpCodes::Load:
+                    valueStack[top++] = slots[instruction.slot];
+                    break;
+            }
+        }
+
+        return top == 0 ? math::Dual { NaN, NaN } : valueStack[top - 1];
+    }
+
+    math::Interval Program::calculateInterval(const math::Interval& x, const math::Interval& y) const {
+        thread_local static math::Interval valueStack[VALUE_STACK_SIZE];
+        const auto slots = valueStack + m_stackDepth;
+        std::size_t top = 0;
+        for (const auto& instruction : m_instructions) {
+            switch (instruction.opcode) {
+                case OpCodes::Number:
+                    valueStack[top++] = math::Interval::point(instruction.immediate.real());
+                    break;
+                case OpCodes::VariableY:
+                    valueStack[top++] = y;
+                    break;
+                case OpCodes::VariableX:
+                case OpCodes::VariableZ:
+                case OpCodes::VariableOther:
+                    valueStack[top++] = x;
+                    break;
+                case OpCodes::Parameter:
+                    valueStack[top++] = math::Interval::point(*instruction.parameter);
+                    break;
+                case OpCodes::ComplexNumber:
+                case OpCodes::Invalid:
+                    valueStack[top++] = math::Interval::empty();
+                    break;
+                case OpCodes::Add: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateIntervalOperator(Operators::Plus, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Subtract: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateIntervalOperator(Operators::Minus, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Multiply: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateIntervalOperator(Operators::Multiplication, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Divide: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateIntervalOperator(Operators::Division, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Module: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateIntervalOperator(Operators::Module, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Power: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = calculateIntervalOperator(Operators::Power, valueStack[top - 1], right);
+                    break;
+                }
+                case OpCodes::Equal: {
+                    const auto right = valueStack[--top];
+                    valueStack[top - 1] = right;
+                    break;
+                }
+                case OpCodes::Negate:
+                    valueStack[top - 1] = -valueStack[top - 1];
+                    break;
+                case OpCodes::Function:
+                    // Unknown function has no values at all 
+                    valueStack[top - 1] = instruction.intervalFunction == nullptr ? 
+                        math::Interval::empty() : instruction.intervalFunction(valueStack[top - 1]);
+                    break;
+                case OpCodes::Store:
+                    slots[instruction.slot] = valueStack[top - 1];
+                    break;
+                case OpCodes::Load:
+                    valueStack[top++] = slots[instruction.slot];
+                    break;
+            }
+        }
+
+        return top == 0 ? math::Interval::empty() : valueStack[top - 1];
+    }
+
+    template<typename T, typename Operation>
+    static inline void applyBinary(T* left, const T* right, std::size_t count, Operation&& operation) {
+        for (std::size_t i = 0; i < count; ++i) {
+            left[i] = operation(left[i], right[i]);
+        }
+    }
+
+    template<typename T, typename Operation>
+    static inline void applyUnary(T* values, std::size_t count, Operation&& operation) {
+        for (std::size_t i = 0; i < count; ++i) {
+            values[i] = operation(values[i]);
+        }
+    }
+
+    void Program::calculateBatch(std::span<const double> xs, std::span<const double> ys, std::span<double> out) const {
+        KUB_ASSERT(xs.size() == ys.size() && xs.size() == out.size(), "program: batch spans have different size");
+        const auto size = std::min({ xs.size(), ys.size(), out.size() });
+        if (m_native != nullptr) {
+            m_native->calculate(xs.data(), ys.data(), out.data(), size);
+            return;
+        }
+
+        for (std::size_t offset = 0; offset < size; offset += BATCH_BLOCK_SIZE) {
+            const auto count = std::min(BATCH_BLOCK_SIZE, size - offset);
+            calculateBlock(xs.data() + offset, ys.data() + offset, out.data() + offset, count);
+        }
+    }
+
+    void Program::calculateComplexBatch(std::span<const double> re, std::span<const double> im, std::span<std::complex<double>> out) const {
+        KUB_ASSERT(re.size() == im.size() && re.size() == out.size(), "program: batch spans have different size");
+        const auto size = std::min({ re.size(), im.size(), out.size() });
+        for (std::size_t offset = 0; offset < size; offset += BATCH_BLOCK_SIZE) {
+            const auto count = std::min(BATCH_BLOCK_SIZE, size - offset);
+            calculateComplexBlock(re.data() + offset, im.data() + offset, out.data() + offset, count);
+        }
+    }
+
+    std::vector<float> Program::getParameterValues() const {
+        std::vector<float> values;
+        for (const auto& instruction : m_instructions) {
+            if (instruction.opcode == OpCodes::Parameter) {
+                values.push_back(*instruction.parameter);
+            }
+        }
+        return values;
+    }
+
+    void Program::calculateBlock(const double* xs, const double* ys, double* out, std::size_t count) const {
+        // Each stack slot is a column of BATCH_BLOCK_SIZE values, 
+        // so every instruction is dispatched once per block instead of once per sample 
+        thread_local static std::vector<double> valueStack;
+        if (valueStack.size() < (m_stackDepth + m_slotCount) * BATCH_BLOCK_SIZE) {
+            valueStack.resize((m_stackDepth + m_slotCount) * BATCH_BLOCK_SIZE);
+        }
+        const auto column = [](std::size_t index) { return valueStack.data() + index * BATCH_BLOCK_SIZE; };
+        const auto slot = [this, &column](std::uint32_t index) { return column(m_stackDepth + index); };
+        static const auto& kernels = simd::getKernelTable();
+
+        std::size_t top = 0;
+        for (const auto& instruction : m_instructions) {
+            switch (instruction.opcode) {
+                case OpCodes::Number:
+                    std::fill_n(column(top++), count, instruction.immediate.real());
+                    break;
+                case OpCodes::VariableY:
+                    std::copy_n(ys, count, column(top++));
+                    break;
+                case OpCodes::VariableX:
+                case OpCodes::VariableZ:
+                case OpCodes::VariableOther:
+                    std::copy_n(xs, count, column(top++));
+                    break;
+                case OpCodes::Parameter:
+                    std::fill_n(column(top++), count, static_cast<double>(*instruction.parameter));
+                    break;
+                // Complex numbers can't be used in real mode calculation
+                case OpCodes::ComplexNumber:
+                case OpCodes::Invalid:
+                    std::fill_n(column(top++), count, std::numeric_limits<double>::quiet_NaN());
+                    break;
+                case OpCodes::Add:
+                    --top;
+                    kernels.add(column(top - 1), column(top), count);
+                    break;
+                case OpCodes::Subtract:
+                    --top;
+                    kernels.subtract(column(top - 1), column(top), count);
+                    break;
+                case OpCodes::Multiply:
+                    --top;
+                    kernels.multiply(column(top - 1), column(top), count);
+                    break;
+                case OpCodes::Divide:
+                    --top;
+                    kernels.divide(column(top - 1), column(top), count);
+                    break;
+                case OpCodes::Module:
+                    --top;
+                    kernels.module(column(top - 1), column(top), count);
+                    break;
+                case OpCodes::Power:
+                    --top;
+                    kernels.power(column(top - 1), column(top), count);
+                    break;
+                case OpCodes::Equal: {
+                    --top;
+                    std::copy_n(column(top), count, column(top - 1));
+                    break;
+                }
+                case OpCodes::Negate:
+                    kernels.negate(column(top - 1), count);
+                    break;
+                case OpCodes::Function: {
+                    if (instruction.functionKernel != nullptr) {
+                        instruction.functionKernel(column(top - 1), count);
+                    } else if (instruction.realFunction == nullptr) {
+                        std::fill_n(column(top - 1), count, std::numeric_limits<double>::quiet_NaN());
+                    } else {
+                        applyUnary(column(top - 1), count, instruction.realFunction);
+                    }
+                    break;
+                }
+                case OpCodes::Store:
+                    std::copy_n(column(top - 1), count, slot(instruction.slot));
+                    break;
+                case OpCodes::Load:
+                    std::copy_n(slot(instruction.slot), count, column(top++));
+                    break;
+            }
+        }
+
+        if (top == 0) {
+            std::fill_n(out, count, std::numeric_limits<double>::quiet_NaN());
+            return;
+        }
+
+        std::copy_n(column(top - 1), count, out);
+    }
+
+    void Program::calculateComplexBlock(const double* re, const double* im, std::complex<double>* out, std::size_t count) const {
+        constexpr auto NaN = std::numeric_limits<double>::quiet_NaN();
+        thread_local static std::vector<std::complex<double>> valueStack;
+        if (valueStack.size() < (m_stackDepth + m_slotCount) * BATCH_BLOCK_SIZE) {
+            valueStack.resize((m_stackDepth + m_slotCount) * BATCH_BLOCK_SIZE);
+        }
+        const auto column = [](std::size_t index) { return valueStack.data() + index * BATCH_BLOCK_SIZE; };
+        const auto slot = [this, &column](std::uint32_t index) { return column(m_stackDepth + index); };
+
+        std::size_t top = 0;
+        for (const auto& instruction : m_instructions) {
+            switch (instruction.opcode) {
+                case OpCodes::Number:
+                case OpCodes::ComplexNumber:
+                    std::fill_n(column(top++), count, instruction.immediate);
+                    break;
+                case OpCodes::VariableZ: {
+                    auto values = column(top++);
+                    for (std::size_t i = 0; i < count; ++i) {
+                        values[i] = { re[i], im[i] };
+                    }
+                    break;
+                }
+                case OpCodes::VariableX:
+                case OpCodes::VariableY: {
+                    auto values = column(top++);
+                    for (std::size_t i = 0; i < count; ++i) {
+                        values[i] = { re[i], 0.0 };
+                    }
+                    break;
+                }
+                case OpCodes::VariableOther:
+                    std::fill_n(column(top++), count, std::complex<double> { 0.0, 0.0 });
+                    break;
+                case OpCodes::Parameter:
+                    std::fill_n(column(top++), count, std::complex<double> { *instruction.parameter, 0.0 });
+                    break;
+                case OpCodes::Invalid:
+                    std::fill_n(column(top++), count, std::complex<double> { NaN, NaN });
+                    break;
+                case OpCodes::Add: {
+                    --top;
+                    applyBinary(column(top - 1), column(top), count, [](const std::complex<double>& left, const std::complex<double>& right) { 
+                        return left + right; 
+                    });
+                    break;
+                }
+                case OpCodes::Subtract: {
+                    --top;
+                    applyBinary(column(top - 1), column(top), count, [](const std::complex<double>& left, const std::complex<double>& right) { 
+                        return left - right; 
+                    });
+                    break;
+                }
+                case OpCodes::Multiply: {
+                    --top;
+                    applyBinary(column(top - 1), column(top), count, [](const std::complex<double>& left, const std::complex<double>& right) { 
+                        return left * right; 
+                    });
+                    break;
+                }
+                case OpCodes::Divide: {
+                    --top;
+                    applyBinary(column(top - 1), column(top), count, [](const std::complex<double>& left, const std::complex<double>& right) { 
+                        return calculateComplexOperator(Operators::Division, left, right); 
+                    });
+                    break;
+                }
+                case OpCodes::Module: {
+                    --top;
+                    applyBinary(column(top - 1), column(top), count, [](const std::complex<double>& left, const std::complex<double>& right) { 
+                        return calculateComplexOperator(Operators::Module, left, right); 
+                    });
+                    break;
+                }
+                case OpCodes::Power: {
+                    --top;
+                    applyBinary(column(top - 1), column(top), count, [](const std::complex<double>& left, const std::complex<double>& right) { 
+                        return calculateComplexOperator(Operators::Power, left, right); 
+                    });
+                    break;
+                }
+                case OpCodes::Equal: {
+                    --top;
+                    std::copy_n(column(top), count, column(top - 1));
+                    break;
+                }
+                case OpCodes::Negate:
+                    applyUnary(column(top - 1), count, [](const std::complex<double>& value) { return -value; });
+                    break;
+                case OpCodes::Function: {
+                    if (instruction.complexFunction == nullptr) {
+                        std::fill_n(column(top - 1), count, std::complex<double> { NaN, NaN });
+                    } else {
+                        applyUnary(column(top - 1), count, instruction.complexFunction);
+                    }
+                    break;
+                }
+                case OpCodes::Store:
+                    std::copy_n(column(top - 1), count, slot(instruction.slot));
+                    break;
+                case OpCodes::Load:
+                    std::copy_n(slot(instruction.slot), count, column(top++));
+                    break;
+            }
+        }
+
+        if (top == 0) {
+            std::fill_n(out, count, std::complex<double> { NaN, NaN });
+            return;
+        }
+
+        std::copy_n(column(top - 1), count, out);
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include "ast_nodes.h"
+#include "math_base.h"
+#include "simd_kernels.h"
+#include "ast_jit.h"
+#include "dual.h"
+#include "interval.h"
+
+#include <vector>
+#include <span>
+#include <memory>
+#include <complex>
+#include <cstdint>
+
+namespace kubvc::algorithm {
+    enum class OpCodes : std::uint8_t {
+        // Push immediate value
+        Number,
+        ComplexNumber,
+        // Push variable value
+        VariableX,
+        VariableY,
+        VariableZ,
+        VariableOther,
+        Parameter,
+        // Binary operators, pop two values and push result
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Module,
+        Power,
+        Equal,
+        // Unary operators, pop one value and push result
+        Negate,
+        Function,
+        // Copy top value to temporary slot, value stays on stack
+        Store,
+        // Push value of temporary slot
+        Load,
+        // Push NaN
+        Invalid,
+    };
+
+    // Variable which derivative is calculated in dual mode
+    enum class DerivativeVariable : std::uint8_t {
+        X,
+        Y,
+    };
+
+    // Flat instruction of compiled program,
+    // it's must stay trivially copyable to keep program in one contiguous block
+    struct Instruction {
+        OpCodes opcode = OpCodes::Invalid;
+        std::complex<double> immediate = { 0.0, 0.0 };
+        // Points to parameter value of variable node, program keeps node alive
+        const float* parameter = nullptr;
+        math::containers::RealFunctionHandler realFunction = nullptr;
+        math::containers::ComplexFunctionHandler complexFunction = nullptr;
+        math::containers::RealFunctionHandler realDerivative = nullptr;
+        math::containers::IntervalFunctionHandler intervalFunction = nullptr;
+        // Vectorized version of real function for batch mode, nullptr if function doesn't have it
+        simd::UnaryKernel functionKernel = nullptr;
+        // Temporary slot index for Store and Load
+        std::uint32_t slot = 0;
+    };
+
+    static_assert(std::is_trivially_copyable_v<Instruction>, "Instruction must be trivially copyable");
+
+    // Postfix program compiled from tree cache
+    class Program {
+        public:
+            static constexpr std::size_t VALUE_STACK_SIZE = 512;
+            // Count of samples which are processed by one instruction at once in batch mode
+            static constexpr std::size_t BATCH_BLOCK_SIZE = 64;
+
+            Program() = default;
+            ~Program() = default;
+
+            // Lower postfix node list to instruction stream, returns nullptr if nodes can't be compiled.
+            // Node which is met again in list is a shared subtree, its value is saved to temporary slot once and loaded after.
+            // If useJit is set, real mode is calculated by native code, interpreter is used when it can't be generated
+            [[nodiscard]] static std::shared_ptr<const Program> compile(std::span<const std::shared_ptr<INode>> nodes, bool useJit = false);
+
+            // Calculate in real mode
+            [[nodiscard]] double calculate(double x, double y) const;
+
+            // Calculate in complex mode
+            [[nodiscard]] std::complex<double> calculateComplex(double re, double im) const;
+
+            // Calculate in real mode with derivative by variable in one pass, 
+            // derivative is NaN if some function doesn't have it
+            [[nodiscard]] math::Dual calculateDual(double x, double y, DerivativeVariable variable) const;
+
+            // Calculate in real mode over intervals of variables, result contains all values which expression 
+            // has in this region. It's empty if expression isn't defined anywhere in region
+            [[nodiscard]] math::Interval calculateInterval(const math::Interval& x, const math::Interval& y) const;
+
+            // Calculate in real mode for each pair of xs and ys, all spans must have same size
+            void calculateBatch(std::span<const double> xs, std::span<const double> ys, std::span<double> out) const;
+
+            // Calculate in complex mode for each pair of re and im, all spans must have same size
+            void calculateComplexBatch(std::span<const double> re, std::span<const double> im, std::span<std::complex<double>> out) const;
+
+            // Hash of instructions, programs of same expression have same hash. 
+            // Parameters are hashed by position only, their values are taken by getParameterValues
+            [[nodiscard]] std::uint64_t getHash() const { return m_hash; }
+            // Current values of parameters in order of instructions, results of calculations are same while they aren't changed
+            [[nodiscard]] std::vector<float> getParameterValues() const;
+
+            [[nodiscard]] std::span<const Instruction> getInstructions() const { return m_instructions; }
+            [[nodiscard]] std::size_t getStackDepth() const { return m_stackDepth; }
+            // Count of temporary slots for shared values, they are placed after value stack 
+            [[nodiscard]] std::size_t getSlotCount() const { return m_slotCount; }
+            // Is real mode calculated by native code
+            [[nodiscard]] bool isNative() const { return m_native != nullptr; }
+
+        private:
+            // Calculate in real mode by interpreter
+            [[nodiscard]] double interpret(double x, double y) const;
+
+            // Compare native code with interpreter on random samples
+            [[nodiscard]] bool verifyNative() const;
+
+            // Run whole program over one block of samples, count <= BATCH_BLOCK_SIZE 
+            void calculateBlock(const double* xs, const double* ys, double* out, std::size_t count) const;
+            void calculateComplexBlock(const double* re, const double* im, std::complex<double>* out, std::size_t count) const;
+
+            std::vector<Instruction> m_instructions;
+            std::size_t m_stackDepth = 0;
+            std::size_t m_slotCount = 0;
+            std::uint64_t m_hash = 0;
+            // Keep nodes which instructions are pointing to
+            std::vector<std::shared_ptr<INode>> m_nodes;
+            std::unique_ptr<NativeProgram> m_native;
+    };
+}
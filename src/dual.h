@@ -0,0 +1,25 @@
+#pragma once
+
+namespace kubvc::math {
+    // Dual number a + b*e where e^2 = 0, calculating function with it gives value and derivative in one pass
+    struct Dual {
+        double value = 0.0;
+        double derivative = 0.0;
+    };
+
+    [[nodiscard]] inline constexpr Dual operator+(const Dual& left, const Dual& right) {
+        return { left.value + right.value, left.derivative + right.derivative };
+    }
+
+    [[nodiscard]] inline constexpr Dual operator-(const Dual& left, const Dual& right) {
+        return { left.value - right.value, left.derivative - right.derivative };
+    }
+
+    [[nodiscard]] inline constexpr Dual operator*(const Dual& left, const Dual& right) {
+        return { left.value * right.value, left.derivative * right.value + left.value * right.derivative };
+    }
+
+    [[nodiscard]] inline constexpr Dual operator-(const Dual& value) {
+        return { -value.value, -value.derivative };
+    }
+}
@@ -21,12 +21,19 @@ namespace kubvc::editor {
     void EditorFpsCounterWindow::onRender(kubvc::render::GUI& gui) {
         static const auto expressionController = math::ExpressionController::getInstance();
         static auto& taskManager = expressionController->getTaskManager();
+        static auto& tileCache = expressionController->getTileCache();
+        static constexpr auto BYTES_IN_MB = 1024.0 * 1024.0;
 
         const auto io = ImGui::GetIO();
         const auto size = io.DisplaySize;
-        ImGui::SetWindowPos({0, size.y - 40.0f});
+        const auto cacheStats = tileCache.getStats();
+        const auto lookups = cacheStats.hits + cacheStats.misses;
+        ImGui::SetWindowPos({0, size.y - 70.0f});
         ImGui::PushFont(&gui.getDefaultFont());
-        ImGui::Text("Fps:%.1f\nExpr Tasks Count:%zu", io.Framerate, taskManager.size());
+        ImGui::Text("Fps:%.1f\nExpr Tasks Count:%zu Dropped:%llu\nTile Cache:%zu tiles %.1f/%.0f MB\nTile Hits:%llu Misses:%llu (%.1f%%)", 
+            io.Framerate, taskManager.size(), static_cast<unsigned long long>(taskManager.getDroppedCount()), cacheStats.tiles, cacheStats.bytes / BYTES_IN_MB, cacheStats.capacity / BYTES_IN_MB,
+            static_cast<unsigned long long>(cacheStats.hits), static_cast<unsigned long long>(cacheStats.misses), 
+            lookups == 0 ? 0.0 : 100.0 * static_cast<double>(cacheStats.hits) / lookups);
         ImGui::PopFont();
     }        
 } 
@@ -277,20 +277,132 @@ namespace kubvc::editor {
                     };
 
                     if (ImGui::InputFloat4(("Grid Size:" + ("##GridSizeInput" + idStr)).c_str(), limits.data())) {
-                        math::GraphLimits::GlobalLimits = math::GraphLimits { limits[0], limits[1], limits[2], limits[3] };
+                        auto& globalLimits = math::GraphLimits::GlobalLimits;
+                        globalLimits.xMin = limits[0];
+                        globalLimits.xMax = limits[1];
+                        globalLimits.yMin = limits[2];
+                        globalLimits.yMax = limits[3];
                         controller->evalExpression(expression, math::GraphLimits::GlobalLimits);
                     }
                 }
 
             }
+            else {
+                ImGui::SeparatorText("Evaluation");
+
+                const auto& expression = selected->getExpression();
+                const auto& idStr = std::to_string(selected->getId());
+                auto& tree = expression->getTree();
 
+                auto isJitEnabled = tree.isJitEnabled();
+                ImGui::BeginDisabled(!algorithm::NativeProgram::isSupported());
+                if (ImGui::Checkbox(("JIT" + ("##JitCheckBox" + idStr)).c_str(), &isJitEnabled)) {
+                    tree.setJitEnabled(isJitEnabled);
+                    controller->evalExpression(expression, math::GraphLimits::GlobalLimits);
+                }
+                ImGui::EndDisabled();
+
+                if (ImGui::IsItemHovered(ImGuiHoveredFlags_::ImGuiHoveredFlags_AllowWhenDisabled)) {
+                    ImGui::SetTooltip("Calculate graph by native code instead of interpreter. Only for x86-64");
+                }
+
+                const auto program = tree.getProgram();
+                if (isJitEnabled && program != nullptr && !program->isNative()) {
+                    ImGui::TextDisabled("Native code isn't available, interpreter is used");
+                }
 
-#if defined(KUB_IS_DEBUG) || defined(SHOW_DEBUG_TOOLS_ON_RELEASE)  
+                const auto pass = expression->getPublishedPass();
+                ImGui::TextDisabled("Last evaluation: %.3f ms, generation %llu%s", expression->getLastEvalTime(), 
+                    static_cast<unsigned long long>(pass.generation), pass.isFinal ? "" : " (coarse)");
+                auto isContourEnabled = expression->isContourEnabled();
+                if (ImGui::Checkbox(("Marching squares" + ("##ContourCheckBox" + idStr)).c_str(), &isContourEnabled)) {
+                    expression->setContourEnabled(isContourEnabled);
+                    controller->evalExpression(expression, math::GraphLimits::GlobalLimits);
+                }
+
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Trace implicit graphs on grid, it finds all branches of curve. Solver finds only one point for each sample");
+                }
+
+                if (expression->getContour() != nullptr) {
+                    const auto contourStats = expression->getContourStats();
+                    ImGui::TextDisabled("Contour: %u polylines, %u evaluations", contourStats.polylines, contourStats.evaluations);
+                    ImGui::TextDisabled("Pruned tiles %u/%u, reused tiles %u, calculated cells %u", contourStats.prunedTiles, contourStats.tiles, 
+                        contourStats.reusedTiles, contourStats.cells);
+                }
+
+                ImGui::BeginDisabled(isContourEnabled);
+                const auto solverType = expression->getSolverType();
+                auto currentSolver = static_cast<std::int32_t>(solverType);
+                const auto& solverNames = math::solvers::RootSolverNames;
+                if (ImGui::BeginCombo(("Solver" + ("##SolverCombo" + idStr)).c_str(), solverNames[currentSolver].data())) {
+                    for (std::int32_t i = 0; i < static_cast<std::int32_t>(solverNames.size()); i++) {
+                        if (ImGui::Selectable(solverNames[i].data(), currentSolver == i)) {
+                            expression->setSolverType(static_cast<math::solvers::RootSolverTypes>(i));
+                            controller->evalExpression(expression, math::GraphLimits::GlobalLimits);
+                        }
+                    }
+                    ImGui::EndCombo();
+                }
+                ImGui::EndDisabled();
+
+                if (ImGui::IsItemHovered(ImGuiHoveredFlags_::ImGuiHoveredFlags_AllowWhenDisabled)) {
+                    ImGui::SetTooltip("Root solver for implicit graphs. Halley needs derivative of expression, otherwise it's same as Newton");
+                }
+
+                const auto solverStats = expression->getSolverStats();
+                if (solverStats.samples > 0) {
+                    const auto roots = solverStats.samples - solverStats.failures;
+                    ImGui::TextDisabled("Solver: %.2f evaluations per root, %.2f iterations per sample", 
+                        roots == 0 ? 0.0 : static_cast<double>(solverStats.evaluations) / roots, 
+                        static_cast<double>(solverStats.iterations) / solverStats.samples);
+                    ImGui::TextDisabled("Warm starts %u/%u, fallbacks %u", solverStats.warmStarts, solverStats.samples, solverStats.fallbacks);
+                }
+
+                auto sampleBudget = static_cast<std::int32_t>(expression->getSampleBudget());
+                if (ImGui::SliderInt(("Point budget" + ("##SampleBudgetSlider" + idStr)).c_str(), &sampleBudget,
+                    math::sampling::MIN_BUDGET, math::sampling::MAX_BUDGET, "%d", ImGuiSliderFlags_Logarithmic)) {
+                    expression->setSampleBudget(static_cast<std::uint32_t>(sampleBudget));
+                    controller->evalExpression(expression, math::GraphLimits::GlobalLimits);
+                }
+
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Max count of points of explicit graph. Graph is subdivided where it bends or jumps");
+                }
+
+                auto minSpacing = static_cast<float>(expression->getMinSampleSpacing());
+                if (ImGui::SliderFloat(("Min spacing" + ("##SampleSpacingSlider" + idStr)).c_str(), &minSpacing, 0.05f, 4.0f, "%.2f px")) {
+                    expression->setMinSampleSpacing(minSpacing);
+                    controller->evalExpression(expression, math::GraphLimits::GlobalLimits);
+                }
+
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Points of explicit graph aren't placed closer than this");
+                }
+
+                const auto samplingStats = expression->getSamplingStats();
+                if (samplingStats.points > 0) {
+                    ImGui::TextDisabled("Sampling: %u points, %u evaluations, %u rounds%s", samplingStats.points, samplingStats.evaluations, 
+                        samplingStats.rounds, samplingStats.isBudgetReached ? ", budget is reached" : "");
+                }
+            }
+
+#if defined(KUB_IS_DEBUG) || defined(SHOW_DEBUG_TOOLS_ON_RELEASE)
             ImGui::Separator();        
             drawIcon(gui, ICON_FA_BUG);
             ImGui::SameLine();        
             ImGui::TextDisabled("Debug");
             drawDebugAST();
+            const auto solverStats = selected->getExpression()->getSolverStats();
+            if (solverStats.samples > 0 && ImGui::CollapsingHeader("Solver iterations")) {
+                const auto getter = [](void* data, std::int32_t index) -> float { 
+                    return static_cast<const std::uint8_t*>(data)[index]; 
+                };
+                ImGui::PlotHistogram("##SolverIterations", getter, const_cast<std::uint8_t*>(solverStats.sampleIterations.data()), 
+                    static_cast<std::int32_t>(solverStats.sampleIterations.size()), 0, nullptr, 0.0f, FLT_MAX, ImVec2(0, 80));
+                ImGui::Text("Failed samples: %u", solverStats.failures);
+            }
+
             const auto& plotBufferPtr = selected->getExpression()->getPlotBuffer();
             if (plotBufferPtr) {
                 const auto points = *plotBufferPtr;
@@ -215,6 +215,30 @@ namespace kubvc::editor {
                     ImGui::PopFont();
                 } 
                 ImGui::SameLine();
+                // Draw derivative button 
+                {
+                    static const auto appConfig = application::ApplicationConfig::getInstance();
+                    const auto isX = currentExpression->getArgumentVariable() == algorithm::DerivativeVariable::X;
+                    const auto isDisabled = !currentExpression->isValid() || appConfig->getMode() != application::MathMode::Real;
+                    
+                    ImGui::PushID(("##" + idStr + "_DerivativeButton").c_str());
+                    ImGui::PushFont(&gui.getDefaultFont());
+                    ImGui::BeginDisabled(isDisabled);
+                    if (ImGui::Button(isX ? "d/dx" : "d/dy")) {
+                        const auto derivativeModel = controller->createDerivative(model, math::GraphLimits::GlobalLimits);
+                        if (derivativeModel != nullptr) {
+                            controller->setSelected(derivativeModel);
+                        }
+                    }
+                    ImGui::EndDisabled();
+
+                    if (ImGui::IsItemHovered(ImGuiHoveredFlags_::ImGuiHoveredFlags_AllowWhenDisabled)) {
+                        ImGui::SetTooltip("Add derivative of this graph as new graph, works only in real mode");
+                    }
+                    ImGui::PopFont();
+                    ImGui::PopID();
+                }
+                ImGui::SameLine();
                 // Draw remove icon 
                 {
                     ImGui::PushID(("##" + idStr + "_ExprButton").c_str());
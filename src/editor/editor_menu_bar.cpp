@@ -211,6 +211,35 @@ namespace kubvc::editor {
                     window->setVsync(!vsync);    
                 }
 
+                ImGui::Separator();
+                auto& taskManager = controller->getTaskManager();
+                static const auto maxThreadCount = static_cast<std::int32_t>(std::max(std::thread::hardware_concurrency() * 2, 2u));
+                static auto threadCount = static_cast<std::int32_t>(taskManager.getThreadCount());
+                ImGui::SliderInt("Worker threads##WorkerThreadsSlider", &threadCount, 1, maxThreadCount);
+                // Workers are restarted, so count is applied when slider is released
+                if (ImGui::IsItemDeactivatedAfterEdit()) {
+                    taskManager.setThreadCount(static_cast<std::size_t>(threadCount));
+                }
+
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Count of threads which evaluate graphs");
+                }
+
+                auto& tileCache = controller->getTileCache();
+                static constexpr std::size_t BYTES_IN_MB = 1024 * 1024;
+                auto capacity = static_cast<std::int32_t>(tileCache.getCapacity() / BYTES_IN_MB);
+                if (ImGui::SliderInt("Tile cache (MB)##TileCacheCapacitySlider", &capacity, 0, 1024)) {
+                    tileCache.setCapacity(static_cast<std::size_t>(capacity) * BYTES_IN_MB);
+                }
+
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Memory for evaluated tiles of graphs, they are reused when view is panned or zoomed back");
+                }
+
+                if (ImGui::MenuItem("Clear tile cache")) {
+                    tileCache.clear();
+                }
+
                 ImGui::EndMenu();
             }
             ImGui::EndMenuBar();
@@ -14,6 +14,7 @@ namespace kubvc::editor {
     void EditorPlotterWindow::onRender([[maybe_unused]] kubvc::render::GUI& gui) {
         static constexpr auto vecStride = 2 * sizeof(double);
         static constexpr auto plotFlags = ImPlotFlags_::ImPlotFlags_NoTitle | ImPlotFlags_::ImPlotFlags_Crosshairs;
+        static constexpr auto COARSE_PASS_ALPHA = 0.5f;
         const auto size = ImGui::GetContentRegionAvail();
         static bool saveLimitsFirstTime = false; 
         
@@ -55,8 +56,14 @@ namespace kubvc::editor {
                 saveLimitsFirstTime = true;
             }	
 
+            // Solver tolerances depend on pixel size
+            const auto plotSize = ImPlot::GetPlotSize();
+            math::GraphLimits::GlobalLimits.setViewportSize(plotSize.x, plotSize.y);
+
             // Draw our functions
             const auto& models = controller->getValidExpressions(); 
+            // Selected graph is re-plotted before other ones
+            const auto selected = controller->getSelected();
             for (std::size_t i = 0; i < models.size(); ++i) {
                 const auto& model = models[i];
                 if (!model) {
@@ -71,7 +78,8 @@ namespace kubvc::editor {
                     if (updateExpressions) {
                         if (appConfig->getMode() == application::MathMode::Real) {
                             math::GraphLimits::GlobalLimits = ImPlot::GetPlotLimits();   
-                            controller->evalExpression(expression, math::GraphLimits::GlobalLimits);
+                            const auto priority = model == selected ? utility::TaskPriority::Interactive : utility::TaskPriority::Visible;
+                            controller->evalExpression(expression, math::GraphLimits::GlobalLimits, priority);
                         }
                     }
                     
@@ -88,7 +96,19 @@ namespace kubvc::editor {
                     
                     switch (appConfig->getMode()) {
                         case application::MathMode::Real: {
-                            if (bufferPtr) {
+                            // Coarse graph is shown dimmer while final one is calculated
+                            if (!expression->getPublishedPass().isFinal) {
+                                specs.LineColor.w *= COARSE_PASS_ALPHA;
+                            }
+
+                            // Implicit graphs are traced to separate polylines
+                            const auto& contourPtr = expression->getContour();
+                            if (contourPtr) {
+                                for (const auto& line : *contourPtr) {
+                                    ImPlot::PlotLine(textBuffer->getBuffer().data(), &line[0].x, &line[0].y, 
+                                        static_cast<std::int32_t>(line.size()), specs);      
+                                }
+                            } else if (bufferPtr) {
                                 const auto& buffer = *bufferPtr;
                                 if (!buffer.empty()) {
                                     ImPlot::PlotLine(textBuffer->getBuffer().data(), &buffer[0].x, &buffer[0].y, 
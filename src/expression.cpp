@@ -3,10 +3,16 @@
 #include "expression_controller.h"
 #include "application_config.h"
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <iterator>
+
 namespace kubvc::math {
     Expression::Expression()  : 
         m_tree(), 
-        m_plotBuffer(std::make_shared<std::vector<glm::dvec2>>(MAX_PLOT_BUFFER_SIZE)),
+        m_plotBuffer(std::make_shared<std::vector<glm::dvec2>>()),
         m_valid(false),
         m_lastErrorMessage(),
         m_primitiveType(primitives::PrimitiveTypes::Circle),
@@ -21,91 +27,99 @@ namespace kubvc::math {
         m_valid = false;
         m_vdc.reset();
         m_tree.clear();
+        m_derivativeTree.clear();
     }
 
-    static constexpr std::uint8_t NEWTON_MAX_ITER = 16; 
-    static constexpr auto EPS = 1e-10;
-
-    inline static double solveBisection(std::function<double(double)> f, double min, double max) {
-        auto fMin = f(min);
-        auto fMax = f(max);
-        
-        if (fMin * fMax >= 0.0) {
-            return std::numeric_limits<double>::quiet_NaN();
-        }
-        
-        while (max - min > 1e-12) {
-            const auto mid = (max + min) * 0.5;
-            const auto fMid = f(mid);
-            
-            if (fMid == 0.0) {
-                return mid;
-            }
-            
-            if (fMin * fMid < 0.0) {
-                max = mid;
-                fMax = fMid;
-            } else {
-                min = mid;
-                fMin = fMid;
-            }
-        }
-        
-        return (max + min) * 0.5;
-    }
-
-    inline static double solveNewton(std::function<double(double)> f, double min, double max) {
-        const auto diff = max - min;
-        const auto eps_step = 1e-7 * diff;
-        const auto eps_abs  = 1e-10 * diff;
+    // Count of samples which are checked by interval calculation at once before solver
+    static constexpr std::int32_t PRUNE_BLOCK_SIZE = 32;
+    // Count of samples which are calculated by one worker
+    static constexpr std::size_t EVAL_CHUNK_SIZE = 128;
+    // Count of complex grid lines which are calculated by one worker
+    static constexpr std::size_t COMPLEX_CHUNK_LINES = 4;
 
-        double x0 = (min + max) * 0.5;
-        double fx0  = f(x0);
-        if (glm::isnan(fx0)) {
-            return std::numeric_limits<double>::quiet_NaN();
-        } 
+    // Count of lattice steps in one cached tile of explicit graph
+    static constexpr std::int64_t SAMPLE_TILE_STEPS = 32;
 
-        for (std::int32_t i = 0; i < NEWTON_MAX_ITER; ++i) {
-            const double dfx0 = (f(x0 + EPS) - f(x0 - EPS)) / (2.0 * EPS);
-            if (glm::isnan(dfx0) || dfx0 == 0.0)
-                return std::numeric_limits<double>::quiet_NaN();
+    // Graphs which were evaluated longer than this count of milliseconds are published by coarse pass first
+    static constexpr double PROGRESSIVE_EVAL_TIME = 2.0;
+    // Count of solver samples in coarse pass
+    static constexpr std::size_t COARSE_PLOT_BUFFER_SIZE = 256;
+    // Cells of coarse contour are bigger in this count of times along each axis
+    static constexpr double COARSE_CELL_SCALE = 4.0;
 
-            const double delta = fx0 / dfx0;
-            x0 -= delta;
+    static_assert(EVAL_CHUNK_SIZE % PRUNE_BLOCK_SIZE == 0, "Prune blocks must not cross chunks");
+    static_assert(Expression::MAX_PLOT_BUFFER_SIZE % EVAL_CHUNK_SIZE == 0, "Plot buffer must be split to whole chunks");
+    static_assert(COARSE_PLOT_BUFFER_SIZE % EVAL_CHUNK_SIZE == 0, "Coarse plot buffer must be split to whole chunks");
 
-  
-            if (x0 < min || x0 > max) {
-                return solveBisection(f, min, max); 
-            }
+    // Tiles of expressions with same program, parameter values and solved variable are same
+    static std::uint64_t getSourceHash(const algorithm::Program* program, bool isYPrefered) {
+        using algorithm::Helpers;
+        if (program == nullptr) {
+            return Helpers::combineHash(0, isYPrefered ? 1 : 0);
+        }
 
-            fx0 = f(x0);
-            if (glm::isnan(fx0)) {
-                return std::numeric_limits<double>::quiet_NaN();
-            } 
+        auto hash = Helpers::combineHash(program->getHash(), isYPrefered ? 1 : 0);
+        for (const auto value : program->getParameterValues()) {
+            hash = Helpers::combineHash(hash, std::bit_cast<std::uint32_t>(value));
+        }
+        return hash;
+    }
 
-            if (glm::abs(delta) < eps_step && glm::abs(fx0) < eps_abs)
-                return x0;
+    utility::TaskFuture Expression::requestEval(const GraphLimits& limits, const std::function<utility::TaskFuture()>& submit) {
+        std::unique_lock lock(m_mutex);
+        m_requestedLimits = limits;
+        m_generation.fetch_add(1, std::memory_order_relaxed);
+        if (!std::exchange(m_isEvalQueued, true)) {
+            m_queuedEval = submit();
         }
-        return std::numeric_limits<double>::quiet_NaN();
+        return m_queuedEval;
+    }
+
+    std::pair<GraphLimits, std::uint64_t> Expression::takeEvalRequest() {
+        std::unique_lock lock(m_mutex);
+        m_isEvalQueued = false;
+        return { m_requestedLimits, m_generation.load(std::memory_order_relaxed) };
     }
 
-    void Expression::eval(const GraphLimits& limits) {   
+    void Expression::eval(const GraphLimits& limits, std::uint64_t generation) {   
         if (!isValid()) {
             return; 
         }
 
+        const auto evalStart = std::chrono::steady_clock::now();
+        const EvalPass finalPass = { generation, true };
         static const auto appConfig = application::ApplicationConfig::getInstance();        
+        static const auto controller = ExpressionController::getInstance();
+        auto& taskManager = controller->getTaskManager();
         switch (appConfig->getMode()) {
             case application::MathMode::Complex: {
                 if (m_rectMode) {
                     const auto& front = m_complexGrid.front();
-                    for (std::size_t i = 0; i < COMPLEX_GRID_SIZE; ++i) {
-                        const auto x = std::lerp(limits.xMin, limits.xMax, static_cast<double>(i) / (COMPLEX_GRID_SIZE - 1));
+                    // Every grid line is calculated by one batch call
+                    taskManager.parallelFor(COMPLEX_GRID_SIZE, COMPLEX_CHUNK_LINES, [&](std::size_t begin, std::size_t end) {
+                        if (isStale(finalPass)) {
+                            return;
+                        }
+
+                        std::array<double, COMPLEX_GRID_LINES_COUNT> re;
+                        std::array<double, COMPLEX_GRID_LINES_COUNT> im;
+                        std::array<std::complex<double>, COMPLEX_GRID_LINES_COUNT> w;
                         for (std::size_t j = 0; j < COMPLEX_GRID_LINES_COUNT; ++j) {
-                            const auto y = std::lerp(limits.yMin, limits.yMax, static_cast<double>(j) / (COMPLEX_GRID_LINES_COUNT - 1));
-                            const auto w = m_tree.calculateComplex(x, y);                        
-                            (*front)[i][j] = { w.real(), w.imag() };
+                            im[j] = std::lerp(limits.yMin, limits.yMax, static_cast<double>(j) / (COMPLEX_GRID_LINES_COUNT - 1));
                         }
+
+                        for (auto i = begin; i < end; ++i) {
+                            const auto x = std::lerp(limits.xMin, limits.xMax, static_cast<double>(i) / (COMPLEX_GRID_SIZE - 1));
+                            re.fill(x);
+                            m_tree.calculateComplexBatch(re, im, w);
+                            for (std::size_t j = 0; j < COMPLEX_GRID_LINES_COUNT; ++j) {
+                                (*front)[i][j] = { w[j].real(), w[j].imag() };
+                            }
+                        }
+                    });
+
+                    if (isStale(finalPass)) {
+                        return;
                     }
                     m_complexGrid.swap();                    
                 } else {                                            
@@ -113,44 +127,455 @@ namespace kubvc::math {
                         return;
                     }
 
-                    const auto& front = m_plotBuffer.front();
                     const auto points = m_primitive->getPoints();
-                    for (std::size_t i = 0; i < points.size(); ++i) {                            
-                        const auto point = points[i];
-                        const auto w = m_tree.calculateComplex(point.x, point.y);
-                        
-                        (*front)[i] = { w.real(), w.imag() };
+                    auto values = std::make_shared<std::vector<glm::dvec2>>(points.size());
+                    taskManager.parallelFor(points.size(), EVAL_CHUNK_SIZE, [&](std::size_t begin, std::size_t end) {
+                        if (isStale(finalPass)) {
+                            return;
+                        }
+
+                        std::array<double, EVAL_CHUNK_SIZE> re;
+                        std::array<double, EVAL_CHUNK_SIZE> im;
+                        std::array<std::complex<double>, EVAL_CHUNK_SIZE> w;
+                        const auto count = end - begin;
+                        for (std::size_t i = 0; i < count; ++i) {                            
+                            re[i] = points[begin + i].x;
+                            im[i] = points[begin + i].y;
+                        }
+
+                        m_tree.calculateComplexBatch(std::span(re).first(count), std::span(im).first(count), std::span(w).first(count));
+                        for (std::size_t i = 0; i < count; ++i) {                            
+                            (*values)[begin + i] = { w[i].real(), w[i].imag() };
+                        }
+                    });
+
+                    if (isStale(finalPass)) {
+                        return;
                     }
 
-                    m_plotBuffer.swap();
+                    std::unique_lock lock(m_mutex);
+                    if (beginPublish(finalPass)) {
+                        swapPlotBuffer(std::move(values));
+                    }
                 }                    
                 break;        
             }
             case application::MathMode::Real: {
-                const auto left = m_vdc.getVariableAtSide(math::VDC::VariableSide::Left);
-                const bool isYPrefered = !left.has_value() || left.value().value == 'y';
-                const auto& front = m_plotBuffer.front();
-                for (std::int32_t i = 0; i < MAX_PLOT_BUFFER_SIZE; ++i) {                              
-                    if (isYPrefered) {                    
-                        const auto x0 = std::lerp(limits.xMin, limits.xMax, static_cast<double>(i) / (MAX_PLOT_BUFFER_SIZE - 1));
-                        const auto f = [this, x0](const double y) {
-                            return m_tree.calculate(x0, y) - y;
-                        };  
-                        const auto y0 = solveNewton(f, limits.yMin, limits.yMax);
-                        (*front)[i] = { x0, y0 };
+                const bool isYPrefered = getArgumentVariable() == algorithm::DerivativeVariable::X;
+                const auto form = m_vdc.getExpressionForm();
+                // Program is taken once, so cached tiles are calculated by same program which their key is made of.
+                // Program which isn't compiled gives empty graph by solver
+                const auto program = m_tree.getProgram();
+                const auto isExplicit = program != nullptr && form == (isYPrefered ? VDC::ExpressionForm::ExplicitX : VDC::ExpressionForm::ExplicitY);
+                const auto isContour = program != nullptr && !isExplicit && isContourEnabled();
+                const auto source = getSourceHash(program.get(), isYPrefered);
+                // Slow graphs are published by coarse pass first, so user sees them after cost of coarse pass only
+                const auto lastEvalTime = getLastEvalTime();
+                const auto isProgressive = lastEvalTime == 0.0 || lastEvalTime > PROGRESSIVE_EVAL_TIME;
+                for (const auto isFinal : { false, true }) {
+                    if (!isFinal && !isProgressive) {
+                        continue;
+                    }
+
+                    const EvalPass pass = { generation, isFinal };
+                    if (isExplicit) {
+                        evalExplicit(limits, *program, isYPrefered, source, pass);
+                    } else if (isContour) {
+                        evalContour(limits, *program, isYPrefered, source, pass);
                     } else {
-                        const auto y0 = std::lerp(limits.yMin, limits.yMax, static_cast<double>(i) / (MAX_PLOT_BUFFER_SIZE - 1));
-                        const auto f = [this, y0](const double x) {
-                            return m_tree.calculate(x, y0) - x;
-                        };  
-                        const auto x0 = solveNewton(f, limits.xMin, limits.xMax);
-                        (*front)[i] = { x0, y0 };
+                        evalSolver(limits, isYPrefered, pass);
                     }
-                } 
-                m_plotBuffer.swap();
+
+                    // Newer evaluation is requested, so it will publish its own passes
+                    if (isStale(pass)) {
+                        return;
+                    }
+                }
                 break;        
             }
         }
+
+        // Time of cancelled evaluation isn't full, so it's not stored
+        const std::chrono::duration<double, std::milli> evalTime = std::chrono::steady_clock::now() - evalStart;
+        m_lastEvalTime.store(evalTime.count(), std::memory_order_relaxed);
+    }
+
+    void Expression::evalSolver(const GraphLimits& limits, bool isYPrefered, const EvalPass& pass) {
+        static const auto controller = ExpressionController::getInstance();
+        auto& taskManager = controller->getTaskManager();
+        const auto sampleMin = isYPrefered ? limits.xMin : limits.yMin;
+        const auto sampleMax = isYPrefered ? limits.xMax : limits.yMax;
+        const auto solveMin = isYPrefered ? limits.yMin : limits.xMin;
+        const auto solveMax = isYPrefered ? limits.yMax : limits.xMax;
+        const auto start = (solveMin + solveMax) * 0.5;
+
+        const Interval solveRange = { solveMin, solveMax };
+        const auto& solver = solvers::getRootSolver(getSolverType());
+        const solvers::RootSolverParams solverParams = {
+            .min = solveMin,
+            .max = solveMax,
+            .guess = start,
+            .pixelSize = isYPrefered ? limits.getPixelHeight() : limits.getPixelWidth()
+        };
+
+        // Solve one sample, warm start is used if there is root of previous sample. Second derivative is used if it's built
+        const auto solveSample = [&](const algorithm::Program& program, const algorithm::Program* derivative, 
+            std::int32_t i, double sample, double previousRoot, double residual, SolverStats& stats) {
+            const auto solve = [&](const solvers::Residual& f) {
+                auto params = solverParams;
+                if (!glm::isnan(previousRoot)) {
+                    params.guess = previousRoot;
+                    params.isLocal = true;
+                    const auto result = solver.solve(f, params);
+                    stats.add(i, result);
+                    if (!glm::isnan(result.root)) {
+                        stats.addWarmStart(i);
+                        return result.root;
+                    }
+                }
+
+                // Warm start is failed or there is no previous root, so we are start from the middle of range,
+                // residual at it is known from batch
+                if (glm::isnan(residual)) {
+                    return std::numeric_limits<double>::quiet_NaN();
+                }
+
+                params.guess = start;
+                params.isLocal = false;
+                const auto result = solver.solve(f, params);
+                stats.add(i, result);
+                return result.root;
+            };
+
+            return isYPrefered ? 
+                solve({
+                    .value = [&program, sample](const double y) { return program.calculate(sample, y) - y; },
+                    .dual = [&program, sample](const double y) { 
+                        return program.calculateDual(sample, y, algorithm::DerivativeVariable::Y) - Dual { y, 1.0 }; 
+                    },
+                    .curvature = derivative == nullptr ? nullptr : std::function<Dual(double)>([derivative, sample](const double y) { 
+                        return derivative->calculateDual(sample, y, algorithm::DerivativeVariable::Y) - Dual { 1.0, 0.0 }; 
+                    })
+                }) : 
+                solve({
+                    .value = [&program, sample](const double x) { return program.calculate(x, sample) - x; },
+                    .dual = [&program, sample](const double x) { 
+                        return program.calculateDual(x, sample, algorithm::DerivativeVariable::X) - Dual { x, 1.0 }; 
+                    },
+                    .curvature = derivative == nullptr ? nullptr : std::function<Dual(double)>([derivative, sample](const double x) { 
+                        return derivative->calculateDual(x, sample, algorithm::DerivativeVariable::X) - Dual { 1.0, 0.0 }; 
+                    })
+                });
+        };
+
+        const std::size_t sampleCount = pass.isFinal ? MAX_PLOT_BUFFER_SIZE : COARSE_PLOT_BUFFER_SIZE;
+        std::array<double, MAX_PLOT_BUFFER_SIZE> samples;
+        std::array<double, MAX_PLOT_BUFFER_SIZE> residuals;
+        std::array<double, MAX_PLOT_BUFFER_SIZE> roots;
+        std::array<bool, MAX_PLOT_BUFFER_SIZE> isPruned { };
+        std::array<SolverStats, MAX_PLOT_BUFFER_SIZE / EVAL_CHUNK_SIZE> chunkStats { };
+        // Each chunk of samples is calculated on its own worker, so solver is warm started only inside of chunk
+        taskManager.parallelFor(sampleCount, EVAL_CHUNK_SIZE, [&](std::size_t begin, std::size_t end) {
+            // Chunks of stale pass are skipped, its result is dropped anyway
+            if (isStale(pass)) {
+                return;
+            }
+
+            const auto count = end - begin;
+            auto& stats = chunkStats[begin / EVAL_CHUNK_SIZE];
+            // Programs are loaded once per chunk, otherwise each solver iteration of each worker 
+            // changes reference counter of same program
+            const auto program = m_tree.getProgram();
+            const auto derivativeProgram = m_derivativeTree.getProgram();
+
+            // Solver starts from the middle of range if there is no root of previous sample, 
+            // so we are calculate residuals at start points for all samples in one batch
+            std::array<double, EVAL_CHUNK_SIZE> starts;
+            for (auto i = begin; i < end; ++i) {                              
+                samples[i] = std::lerp(sampleMin, sampleMax, static_cast<double>(i) / static_cast<double>(sampleCount - 1));
+            }
+            starts.fill(start);
+
+            if (program == nullptr) {
+                std::fill(roots.begin() + begin, roots.begin() + end, std::numeric_limits<double>::quiet_NaN());
+                return;
+            }
+
+            const auto sampleSpan = std::span(samples).subspan(begin, count);
+            const auto startSpan = std::span(starts).first(count);
+            const auto residualSpan = std::span(residuals).subspan(begin, count);
+            if (isYPrefered) {
+                program->calculateBatch(sampleSpan, startSpan, residualSpan);
+            } else {
+                program->calculateBatch(startSpan, sampleSpan, residualSpan);
+            }
+
+            // Neighbour samples have close roots, so each sample starts from root of previous one
+            auto previousRoot = std::numeric_limits<double>::quiet_NaN();
+            for (auto i = static_cast<std::int32_t>(begin); i < static_cast<std::int32_t>(end); ++i) {                              
+                // If residual has no zero over whole block of samples and whole range of solver,
+                // curve doesn't cross this part of viewport and we can skip solver for all block
+                if (i % PRUNE_BLOCK_SIZE == 0) {
+                    const auto last = std::min(i + PRUNE_BLOCK_SIZE, static_cast<std::int32_t>(end)) - 1;
+                    const Interval block = { samples[i], samples[last] };
+                    const auto residualRange = isYPrefered ? program->calculateInterval(block, solveRange) - solveRange : 
+                        program->calculateInterval(solveRange, block) - solveRange;
+                    if (!residualRange.contains(0.0)) {
+                        std::fill(roots.begin() + i, roots.begin() + last + 1, std::numeric_limits<double>::quiet_NaN());
+                        std::fill(isPruned.begin() + i, isPruned.begin() + last + 1, true);
+                        previousRoot = std::numeric_limits<double>::quiet_NaN();
+                        i = last;
+                        continue;
+                    }
+                }
+
+                ++stats.samples;
+                roots[i] = solveSample(*program, derivativeProgram.get(), i, samples[i], previousRoot, residuals[i], stats);
+                stats.failures += glm::isnan(roots[i]) ? 1 : 0;
+                previousRoot = roots[i];
+            } 
+        });
+
+        if (isStale(pass)) {
+            return;
+        }
+
+        SolverStats stats { };
+        for (std::size_t chunk = 0; chunk < sampleCount / EVAL_CHUNK_SIZE; ++chunk) {
+            stats.merge(chunkStats[chunk], chunk * EVAL_CHUNK_SIZE, (chunk + 1) * EVAL_CHUNK_SIZE);
+        }
+
+        // First samples of chunks were solved without root of previous chunk, so they can be on other branch of curve.
+        // Solve them again same as in one pass until previous root is same as in chunk, it's usually only one sample.
+        // Samples are already counted by chunks, so result of sample replaces its result in chunk and work of solver is added
+        const auto isSameRoot = [](double a, double b) { return a == b || (glm::isnan(a) && glm::isnan(b)); };
+        SolverStats fixStats { };
+        const auto program = m_tree.getProgram();
+        const auto derivativeProgram = m_derivativeTree.getProgram();
+        for (auto begin = EVAL_CHUNK_SIZE; program != nullptr && begin < sampleCount; begin += EVAL_CHUNK_SIZE) {
+            auto previousRoot = roots[begin - 1];
+            auto chunkPreviousRoot = std::numeric_limits<double>::quiet_NaN();
+            for (auto i = static_cast<std::int32_t>(begin); i < static_cast<std::int32_t>(sampleCount) && !isPruned[i]; ++i) {
+                if (isSameRoot(previousRoot, chunkPreviousRoot)) {
+                    break;
+                }
+
+                const auto root = solveSample(*program, derivativeProgram.get(), i, samples[i], previousRoot, residuals[i], fixStats);
+                stats.failures += glm::isnan(root) ? 1 : 0;
+                stats.failures -= glm::isnan(roots[i]) ? 1 : 0;
+                stats.replace(fixStats, i);
+                chunkPreviousRoot = roots[i];
+                previousRoot = roots[i] = root;
+            }
+        }
+        stats.iterations += fixStats.iterations;
+        stats.evaluations += fixStats.evaluations;
+
+        auto points = std::make_shared<std::vector<glm::dvec2>>(sampleCount);
+        for (std::size_t i = 0; i < sampleCount; ++i) {
+            (*points)[i] = isYPrefered ? glm::dvec2 { samples[i], roots[i] } : glm::dvec2 { roots[i], samples[i] };
+        }
+
+        std::unique_lock lock(m_mutex);
+        if (!beginPublish(pass)) {
+            return;
+        }
+
+        m_solverStats = stats;
+        m_samplingStats = { };
+        m_contour = nullptr;
+        swapPlotBuffer(std::move(points));
+    }
+
+    void Expression::evalExplicit(const GraphLimits& limits, const algorithm::Program& program, bool isYPrefered, std::uint64_t source, const EvalPass& pass) {
+        static const auto controller = ExpressionController::getInstance();
+        auto& cache = controller->getTileCache();
+        // Value side doesn't depend on solved variable, so it's calculated at any point of solved axis
+        const auto start = isYPrefered ? (limits.yMin + limits.yMax) * 0.5 : (limits.xMin + limits.xMax) * 0.5;
+        // Sampler calls function for each round of refinement, so buffer of start points grows only if round is bigger
+        std::vector<double> startBuffer;
+        const sampling::BatchFunction f = [&program, isYPrefered, start, &startBuffer](std::span<const double> samples, std::span<double> values) {
+            if (startBuffer.size() < samples.size()) {
+                startBuffer.resize(samples.size(), start);
+            }
+
+            const auto starts = std::span<const double>(startBuffer).first(samples.size());
+            if (isYPrefered) {
+                program.calculateBatch(samples, starts, values);
+            } else {
+                program.calculateBatch(starts, samples, values);
+            }
+        };
+
+        sampling::AdaptiveSamplerParams params = {
+            .min = isYPrefered ? limits.xMin : limits.yMin,
+            .max = isYPrefered ? limits.xMax : limits.yMax,
+            .valueMin = isYPrefered ? limits.yMin : limits.xMin,
+            .valueMax = isYPrefered ? limits.yMax : limits.xMax,
+            .samplePixel = isYPrefered ? limits.getPixelWidth() : limits.getPixelHeight(),
+            .valuePixel = isYPrefered ? limits.getPixelHeight() : limits.getPixelWidth()
+        };
+        params.isCancelled = [this, &pass]() { return isStale(pass); };
+
+        {
+            std::shared_lock lock(m_mutex);
+            // Coarse pass takes only initial samples without refinement
+            params.budget = pass.isFinal ? m_sampleBudget : 0;
+            params.minSpacing = m_minSampleSpacing;
+        }
+
+        // Tiles are ranges of lattice steps at zoom level, sampler takes values of their points instead of calculation
+        const auto level = sampling::getLatticeLevel(params.min, params.max);
+        const auto step = std::ldexp(1.0, level);
+        const auto tileSize = step * SAMPLE_TILE_STEPS;
+        const auto firstTile = static_cast<std::int64_t>(std::floor(std::floor(params.min / step) * step / tileSize));
+        const auto lastTile = static_cast<std::int64_t>(std::floor(std::ceil(params.max / step) * step / tileSize));
+        const auto keyOf = [source, level](std::int64_t tile) { return TileKey { .source = source, .kind = TileKind::Samples, .levelX = level, .x = tile }; };
+
+        std::vector<std::shared_ptr<const TileCache::Samples>> tiles;
+        std::vector<glm::dvec2> previous;
+        for (auto tile = firstTile; tile <= lastTile; ++tile) {
+            auto points = cache.find<TileCache::Samples>(keyOf(tile));
+            if (points != nullptr) {
+                previous.insert(previous.end(), points->begin(), points->end());
+            }
+            tiles.push_back(std::move(points));
+        }
+        params.previous = previous;
+
+        sampling::SamplingStats stats { };
+        const auto samples = sampling::sample(f, params, stats);
+        if (isStale(pass)) {
+            return;
+        }
+
+        // Tile keeps points of all views at its zoom level, so new points are added to cached ones
+        const auto isBefore = [](const glm::dvec2& a, const glm::dvec2& b) { return a.x < b.x; };
+        auto begin = samples.begin();
+        for (auto tile = firstTile; tile <= lastTile; ++tile) {
+            const auto end = std::lower_bound(begin, samples.end(), glm::dvec2 { static_cast<double>(tile + 1) * tileSize, 0.0 }, isBefore);
+            const auto& cached = tiles[static_cast<std::size_t>(tile - firstTile)];
+            auto points = std::make_shared<TileCache::Samples>();
+            if (cached != nullptr) {
+                std::set_union(cached->begin(), cached->end(), begin, end, std::back_inserter(*points), isBefore);
+            } else {
+                points->assign(begin, end);
+            }
+
+            if (!points->empty() && (cached == nullptr || points->size() != cached->size()) && isSourceKept(program, isYPrefered, source, pass)) {
+                cache.insert(keyOf(tile), std::move(points));
+            }
+            begin = end;
+        }
+
+        // Points outside of range are skipped same as solver does
+        auto points = std::make_shared<std::vector<glm::dvec2>>(samples.size());
+        for (std::size_t i = 0; i < samples.size(); ++i) {
+            const auto& sample = samples[i];
+            const auto value = sample.y >= params.valueMin && sample.y <= params.valueMax ? sample.y : std::numeric_limits<double>::quiet_NaN();
+            (*points)[i] = isYPrefered ? glm::dvec2 { sample.x, value } : glm::dvec2 { value, sample.x };
+        }
+
+        std::unique_lock lock(m_mutex);
+        if (!beginPublish(pass)) {
+            return;
+        }
+
+        m_samplingStats = stats;
+        m_solverStats = { };
+        m_contour = nullptr;
+        swapPlotBuffer(std::move(points));
+    }
+
+    bool Expression::isStale(const EvalPass& pass) const {
+        return m_generation.load(std::memory_order_relaxed) != pass.generation;
+    }
+
+    bool Expression::isSourceKept(const algorithm::Program& program, bool isYPrefered, std::uint64_t source, const EvalPass& pass) const {
+        // Parameters are read by program while it calculates, so they can be changed in middle of evaluation
+        return !isStale(pass) && getSourceHash(&program, isYPrefered) == source;
+    }
+
+    bool Expression::beginPublish(const EvalPass& pass) {
+        // Evaluations can be finished out of order, so older one must not replace graph of newer one
+        const auto isNewer = pass.generation > m_publishedPass.generation || 
+            (pass.generation == m_publishedPass.generation && pass.isFinal && !m_publishedPass.isFinal);
+        if (!isNewer) {
+            return false;
+        }
+
+        m_publishedPass = pass;
+        return true;
+    }
+
+    void Expression::swapPlotBuffer(std::shared_ptr<std::vector<glm::dvec2>> points) {
+        // Buffer is replaced instead of writing to it, so its size can be changed while renderer holds old one
+        m_plotBuffer.back() = std::move(points);
+        m_plotBuffer.swap();
+    }
+
+    Expression::EvalPass Expression::getPublishedPass() const {
+        std::shared_lock lock(m_mutex);        
+        return m_publishedPass;
+    }
+
+    void Expression::evalContour(const GraphLimits& limits, const algorithm::Program& program, bool isYPrefered, std::uint64_t source, const EvalPass& pass) {
+        static const auto controller = ExpressionController::getInstance();
+        // Calculated value is right side of expression, so residual is difference with solved variable same as in solver
+        const contour::Residual residual = {
+            .batch = [&program, isYPrefered](std::span<const double> xs, std::span<const double> ys, std::span<double> out) {
+                program.calculateBatch(xs, ys, out);
+                const auto solved = isYPrefered ? ys : xs;
+                for (std::size_t i = 0; i < out.size(); ++i) {
+                    out[i] -= solved[i];
+                }
+            },
+            .interval = [&program, isYPrefered](const Interval& x, const Interval& y) { 
+                return program.calculateInterval(x, y) - (isYPrefered ? y : x); 
+            }
+        };
+
+        auto& cache = controller->getTileCache();
+        const auto keyOf = [source](const contour::TileIndex& index) {
+            return TileKey { source, TileKind::Contour, index.levelX, index.levelY, index.x, index.y };
+        };
+
+        const contour::TileStorage storage = {
+            .find = [&cache, &keyOf](const contour::TileIndex& index) { return cache.find<contour::TileResult>(keyOf(index)); },
+            .store = [this, &cache, &keyOf, &program, isYPrefered, source, &pass](const contour::TileIndex& index, std::shared_ptr<const contour::TileResult> tile) { 
+                if (isSourceKept(program, isYPrefered, source, pass)) {
+                    cache.insert(keyOf(index), std::move(tile)); 
+                }
+            }
+        };
+
+        // Coarse pass traces bigger cells, their tiles are cached at own zoom level
+        const contour::TraceParams params = {
+            .cellPixels = pass.isFinal ? contour::CELL_PIXELS : contour::CELL_PIXELS * COARSE_CELL_SCALE,
+            .isCancelled = [this, &pass]() { return isStale(pass); }
+        };
+
+        contour::ContourStats stats { };
+        auto polylines = contour::trace(residual, limits, controller->getTaskManager(), storage, params, stats);
+        if (isStale(pass)) {
+            return;
+        }
+
+        std::unique_lock lock(m_mutex);
+        if (!beginPublish(pass)) {
+            return;
+        }
+
+        m_contour = std::make_shared<const Contour>(std::move(polylines));
+        m_contourStats = stats;
+        m_solverStats = { };
+        m_samplingStats = { };
+    }
+
+    algorithm::DerivativeVariable Expression::getArgumentVariable() const {
+        const auto left = m_vdc.getVariableAtSide(math::VDC::VariableSide::Left);
+        const bool isYPrefered = !left.has_value() || left.value().value == 'y';
+        return isYPrefered ? algorithm::DerivativeVariable::X : algorithm::DerivativeVariable::Y;
     }
 
     void Expression::setValid(bool isValid, std::string_view lastMessage) {
@@ -191,9 +616,125 @@ namespace kubvc::math {
     }
 
     std::shared_ptr<const std::vector<glm::dvec2>> Expression::getPlotBuffer() const {
+        std::shared_lock lock(m_mutex);
         return m_plotBuffer.front();
     }
 
+    void Expression::SolverStats::add(std::int32_t sample, const solvers::RootSolverResult& result) {
+        iterations += result.iterations;
+        evaluations += result.evaluations;
+        if (result.isFallback && !sampleFallbacks.test(sample)) {
+            ++fallbacks;
+            sampleFallbacks.set(sample);
+        }
+
+        const auto sampleTotal = sampleIterations[sample] + result.iterations;
+        sampleIterations[sample] = static_cast<std::uint8_t>(std::min<std::uint32_t>(sampleTotal, UINT8_MAX));
+    }
+
+    void Expression::SolverStats::merge(const SolverStats& other, std::size_t begin, std::size_t end) {
+        samples += other.samples;
+        warmStarts += other.warmStarts;
+        iterations += other.iterations;
+        evaluations += other.evaluations;
+        fallbacks += other.fallbacks;
+        failures += other.failures;
+        std::copy(other.sampleIterations.begin() + begin, other.sampleIterations.begin() + end, sampleIterations.begin() + begin);
+        for (auto i = begin; i < end; ++i) {
+            sampleWarmStarts[i] = other.sampleWarmStarts[i];
+            sampleFallbacks[i] = other.sampleFallbacks[i];
+        }
+    }
+
+    void Expression::SolverStats::addWarmStart(std::int32_t sample) {
+        ++warmStarts;
+        sampleWarmStarts.set(sample);
+    }
+
+    void Expression::SolverStats::replace(const SolverStats& other, std::int32_t sample) {
+        warmStarts = warmStarts - sampleWarmStarts[sample] + other.sampleWarmStarts[sample];
+        fallbacks = fallbacks - sampleFallbacks[sample] + other.sampleFallbacks[sample];
+        sampleWarmStarts[sample] = other.sampleWarmStarts[sample];
+        sampleFallbacks[sample] = other.sampleFallbacks[sample];
+        sampleIterations[sample] = other.sampleIterations[sample];
+    }
+
+    void Expression::setSolverType(solvers::RootSolverTypes type) {
+        std::unique_lock lock(m_mutex);
+        m_solverType = type;
+    }
+
+    solvers::RootSolverTypes Expression::getSolverType() const {
+        std::shared_lock lock(m_mutex);        
+        return m_solverType;
+    }
+
+    void Expression::buildSolverDerivative() {
+        static const auto builder = algorithm::ASTBuilder::getInstance();
+        // Explicit expressions are calculated without solver
+        if (m_vdc.getExpressionForm() != VDC::ExpressionForm::Implicit) {
+            m_derivativeTree.clear();
+            return;
+        }
+
+        // Solved variable is opposite to argument one
+        const auto variable = getArgumentVariable() == algorithm::DerivativeVariable::X ? 
+            algorithm::DerivativeVariable::Y : algorithm::DerivativeVariable::X;
+        if (!builder->buildDerivative(m_derivativeTree, m_tree, m_vdc, variable)) {
+            KUB_DEBUG("solver: expression doesn't have derivative, Halley is same as Newton");
+        }
+    }
+
+    std::shared_ptr<const Expression::Contour> Expression::getContour() const {
+        std::shared_lock lock(m_mutex);        
+        return m_contour;
+    }
+
+    contour::ContourStats Expression::getContourStats() const {
+        std::shared_lock lock(m_mutex);        
+        return m_contourStats;
+    }
+
+    bool Expression::isContourEnabled() const {
+        std::shared_lock lock(m_mutex);        
+        return m_contourEnabled;
+    }
+
+    void Expression::setContourEnabled(bool isEnabled) {
+        std::unique_lock lock(m_mutex);
+        m_contourEnabled = isEnabled;
+    }
+
+    sampling::SamplingStats Expression::getSamplingStats() const {
+        std::shared_lock lock(m_mutex);        
+        return m_samplingStats;
+    }
+
+    std::uint32_t Expression::getSampleBudget() const {
+        std::shared_lock lock(m_mutex);        
+        return m_sampleBudget;
+    }
+
+    double Expression::getMinSampleSpacing() const {
+        std::shared_lock lock(m_mutex);        
+        return m_minSampleSpacing;
+    }
+
+    void Expression::setSampleBudget(std::uint32_t budget) {
+        std::unique_lock lock(m_mutex);
+        m_sampleBudget = std::clamp(budget, sampling::MIN_BUDGET, sampling::MAX_BUDGET);
+    }
+
+    void Expression::setMinSampleSpacing(double spacing) {
+        std::unique_lock lock(m_mutex);
+        m_minSampleSpacing = std::max(spacing, 0.0);
+    }
+
+    Expression::SolverStats Expression::getSolverStats() const {
+        std::shared_lock lock(m_mutex);        
+        return m_solverStats;
+    }
+
     std::string Expression::getLastErrorMessage() const {
         std::shared_lock lock(m_mutex);        
         return m_lastErrorMessage;
@@ -5,9 +5,17 @@
 #include "variable_dependence.h"
 #include "primitives.h"
 #include "double_buffer.h"
+#include "root_solver.h"
+#include "marching_squares.h"
+#include "adaptive_sampler.h"
 
 #include <mutex>
 #include <shared_mutex>
+#include <atomic>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <utility>
 
 namespace kubvc::math {
     class ExpressionController;
@@ -15,13 +23,49 @@ namespace kubvc::math {
         public:
             using GridBuffer = utility::DoubleBuffer<std::shared_ptr<std::vector<std::vector<glm::dvec2>>>>;
             using PlotBuffer = utility::DoubleBuffer<std::shared_ptr<std::vector<glm::dvec2>>>;
+            using Contour = std::vector<contour::Polyline>;
 
             friend ExpressionController;
 
+            // Count of samples for solver and complex primitives, explicit graphs are sampled adaptively up to their budget
             static constexpr auto MAX_PLOT_BUFFER_SIZE = 1024;
             static constexpr auto COMPLEX_GRID_SIZE = 32;
             static constexpr auto COMPLEX_GRID_LINES_COUNT = 128;
 
+            // Solver statistics of last evaluation in real mode, explicit expressions don't use solver
+            struct SolverStats {
+                // Samples which were given to solver, pruned ones are not counted
+                std::uint32_t samples = 0;
+                // Samples which are solved from root of previous sample
+                std::uint32_t warmStarts = 0;
+                std::uint32_t iterations = 0;
+                // Calculations of residual, they are main cost of solver
+                std::uint32_t evaluations = 0;
+                // Open method is failed and root is searched by bracketing one
+                std::uint32_t fallbacks = 0;
+                // Samples without root
+                std::uint32_t failures = 0;
+                // Solver iterations for each sample
+                std::array<std::uint8_t, MAX_PLOT_BUFFER_SIZE> sampleIterations { };
+                // Samples which are counted by warm starts and fallbacks, so sample which is solved again replaces its counts
+                std::bitset<MAX_PLOT_BUFFER_SIZE> sampleWarmStarts;
+                std::bitset<MAX_PLOT_BUFFER_SIZE> sampleFallbacks;
+
+                void add(std::int32_t sample, const solvers::RootSolverResult& result);
+                void addWarmStart(std::int32_t sample);
+                // Add counters of other stats and take its samples in [begin, end)
+                void merge(const SolverStats& other, std::size_t begin, std::size_t end);
+                // Take result of sample from other stats which solved it again, work of both solves is counted
+                void replace(const SolverStats& other, std::int32_t sample);
+            };
+
+            // Graph of slow expression is published twice by one evaluation, coarse pass is shown while final one is calculated
+            struct EvalPass {
+                // Number of evaluation, passes of older evaluations are dropped
+                std::uint64_t generation = 0;
+                bool isFinal = true;
+            };
+
             Expression();
             Expression(const Expression& expression) = delete;
             Expression(Expression&& expression) = delete;
@@ -32,14 +76,39 @@ namespace kubvc::math {
             [[nodiscard]] algorithm::ASTree& getTree() { return m_tree; }
             [[nodiscard]] std::shared_ptr<const std::vector<std::vector<glm::dvec2>>> getComplexGrid() const;
             [[nodiscard]] std::shared_ptr<const std::vector<glm::dvec2>> getPlotBuffer() const;
+            // Polylines of implicit curve, it's nullptr if graph is calculated to plot buffer
+            [[nodiscard]] std::shared_ptr<const Contour> getContour() const;
             [[nodiscard]] std::string getLastErrorMessage() const;
             [[nodiscard]] bool getRectMode() const;
             [[nodiscard]] bool isValid() const;
             [[nodiscard]] math::primitives::PrimitiveTypes getPrimitiveType() const;
+            // Variable which graph is calculated along in real mode, it's x for y = f(x) and y for x = f(y)
+            [[nodiscard]] algorithm::DerivativeVariable getArgumentVariable() const;
+            // Time of last evaluation in milliseconds
+            [[nodiscard]] double getLastEvalTime() const { return m_lastEvalTime.load(std::memory_order_relaxed); }
+            [[nodiscard]] SolverStats getSolverStats() const;
+            [[nodiscard]] solvers::RootSolverTypes getSolverType() const;
+            [[nodiscard]] contour::ContourStats getContourStats() const;
+            // Stats of adaptive sampling of explicit graph, it's empty for other graphs
+            [[nodiscard]] sampling::SamplingStats getSamplingStats() const;
+            // Max count of points of explicit graph
+            [[nodiscard]] std::uint32_t getSampleBudget() const;
+            // Points of explicit graph aren't closer than this count of pixels
+            [[nodiscard]] double getMinSampleSpacing() const;
+            // Implicit graphs are traced by marching squares instead of solver
+            [[nodiscard]] bool isContourEnabled() const;
+            // Pass which graph is calculated by now
+            [[nodiscard]] EvalPass getPublishedPass() const;
 
             void setRectMode(bool rectMode);
             void setValid(bool isValid, std::string_view lastMessage);
             void setPrimitiveType(math::primitives::PrimitiveTypes type);
+            void setSolverType(solvers::RootSolverTypes type);
+            void setContourEnabled(bool isEnabled);
+            void setSampleBudget(std::uint32_t budget);
+            void setMinSampleSpacing(double spacing);
+            // Build derivative by solved variable for solvers which need second derivative, it's called after tree is built
+            void buildSolverDerivative();
 
             template <primitives::IsPrimitive T>
             void setNewPrimitive(std::shared_ptr<T> primitive);
@@ -48,17 +117,54 @@ namespace kubvc::math {
             [[nodiscard]] std::shared_ptr<T> getPrimitive() const;
 
         private:
-            // Evaluate current expression 
-            void eval(const GraphLimits& limits);
+            // Evaluate current expression, generation is taken from request of evaluation
+            void eval(const GraphLimits& limits, std::uint64_t generation);
+            // Store limits of new evaluation and cancel running one. Task is queued by submit only if evaluation isn't queued yet,
+            // otherwise queued task takes these limits. Returns future of queued evaluation
+            utility::TaskFuture requestEval(const GraphLimits& limits, const std::function<utility::TaskFuture()>& submit);
+            // Take limits and generation of latest request, it's called by queued task when it's started
+            [[nodiscard]] std::pair<GraphLimits, std::uint64_t> takeEvalRequest();
+            // Sample explicit graph in real mode, source is hash of program for tile cache
+            void evalExplicit(const GraphLimits& limits, const algorithm::Program& program, bool isYPrefered, std::uint64_t source, const EvalPass& pass);
+            // Trace implicit curve in real mode
+            void evalContour(const GraphLimits& limits, const algorithm::Program& program, bool isYPrefered, std::uint64_t source, const EvalPass& pass);
+            // Solve implicit expression for each sample of argument variable
+            void evalSolver(const GraphLimits& limits, bool isYPrefered, const EvalPass& pass);
+            // Newer evaluation is started after this pass
+            [[nodiscard]] bool isStale(const EvalPass& pass) const;
+            // Tiles are stored only if pass isn't stale and program still has parameters of source hash
+            [[nodiscard]] bool isSourceKept(const algorithm::Program& program, bool isYPrefered, std::uint64_t source, const EvalPass& pass) const;
+            // Pass is published if it's newer than published one, final pass replaces coarse pass of same evaluation.
+            // Mutex must be locked
+            [[nodiscard]] bool beginPublish(const EvalPass& pass);
+            // Replace plot buffer by new points, mutex must be locked
+            void swapPlotBuffer(std::shared_ptr<std::vector<glm::dvec2>> points);
             
             math::VariableDependenceController m_vdc;
             // Abstract syntax tree for expressions 
             algorithm::ASTree m_tree;
+            // Derivative of expression by solved variable, it's empty for explicit expressions
+            algorithm::ASTree m_derivativeTree;
             // Calculated points for graph
             PlotBuffer m_plotBuffer;  
+            std::shared_ptr<const Contour> m_contour;
 
             bool m_valid = false;
             std::string m_lastErrorMessage;
+            std::atomic<double> m_lastEvalTime = 0.0;
+            // Generation of last requested evaluation, running evaluations of older generations are cancelled
+            std::atomic<std::uint64_t> m_generation = 0;
+            EvalPass m_publishedPass;
+            GraphLimits m_requestedLimits;
+            bool m_isEvalQueued = false;
+            utility::TaskFuture m_queuedEval;
+            SolverStats m_solverStats;
+            solvers::RootSolverTypes m_solverType = solvers::RootSolverTypes::Newton;
+            contour::ContourStats m_contourStats;
+            bool m_contourEnabled = true;
+            sampling::SamplingStats m_samplingStats;
+            std::uint32_t m_sampleBudget = sampling::DEFAULT_BUDGET;
+            double m_minSampleSpacing = sampling::DEFAULT_MIN_SPACING;
 
             mutable std::shared_mutex m_mutex;
             
@@ -3,7 +3,11 @@
 #include "expression_model.h"
 #include "logger.h"
 #include "macro_controller.h"
+#include "ast_printer.h"
+#include "tile_cache.h"
+#include "task_coroutine.h"
 
+#include <algorithm>
 #include <unordered_set>
 #include <shared_mutex>
 #include <span>
@@ -21,14 +25,20 @@ namespace kubvc::math {
             void resetSelected();
             void setSelected(std::shared_ptr<ExpressionModel> selected);
                        
-            // Parse current text then evaluate 
-            void parseThenEvaluate(std::shared_ptr<ExpressionModel> model, const GraphLimits& limits); 
+            // Parse current text then evaluate, future is finished after evaluation
+            utility::TaskFuture parseThenEvaluate(std::shared_ptr<ExpressionModel> model, const GraphLimits& limits); 
             
-            // Run evaluate task for expression
-            void evalExpression(std::shared_ptr<Expression> expr, const GraphLimits& limits);
+            // Run evaluate task for expression, future is finished after it. Evaluation can be cancelled by newer request 
+            utility::TaskFuture evalExpression(std::shared_ptr<Expression> expr, const GraphLimits& limits, 
+                utility::TaskPriority priority = utility::TaskPriority::Visible);
             
+            // Selected expression is evaluated first, hidden ones are evaluated after visible ones
             void reevaluateAllExpressions(const GraphLimits& limits); 
 
+            // Create new graph with derivative of model expression by its argument variable, 
+            // returns nullptr if derivative can't be built
+            std::shared_ptr<ExpressionModel> createDerivative(std::shared_ptr<ExpressionModel> model, const GraphLimits& limits);
+
             [[nodiscard]] std::shared_ptr<ExpressionModel> get(std::size_t index) const;
             [[nodiscard]] std::shared_ptr<ExpressionModel> getSelected() const;
 
@@ -41,48 +51,87 @@ namespace kubvc::math {
             // Note: Use only for expressions. Because if parseThenEvaluate() fails 
             // or if clear() is called, your tasks will be destroyed 
             [[nodiscard]] utility::TaskManager& getTaskManager() { return m_taskManager; }
+            // Evaluated tiles of all graphs in real mode
+            [[nodiscard]] TileCache& getTileCache() { return m_tileCache; }
         private:
+            // Parse, build and evaluate stages of model. Pipeline is stopped between stages if text is changed meanwhile
+            utility::AsyncTask parse(std::shared_ptr<ExpressionModel> model);
+            // Lexer keeps error of last tokenize, so each worker has own one
+            [[nodiscard]] static algorithm::Lexer& getWorkerLexer();
+
             utility::TaskManager m_taskManager;
+            TileCache m_tileCache;
             std::vector<std::shared_ptr<ExpressionModel>> m_validExpressions;
             std::vector<std::shared_ptr<ExpressionModel>> m_expressions;  
             std::shared_ptr<ExpressionModel> m_selected;
             mutable std::shared_mutex m_mutex;
     };
     
-    inline void ExpressionController::parseThenEvaluate(std::shared_ptr<ExpressionModel> model, const GraphLimits& limits) {
-        static const auto builder = kubvc::algorithm::ASTBuilder::getInstance();
+    inline utility::TaskFuture ExpressionController::parseThenEvaluate(std::shared_ptr<ExpressionModel> model, const GraphLimits& limits) {
         KUB_ASSERT(model != nullptr, "Model are nullptr");
 
-        m_taskManager.add([this, model, limits] {
-            static const auto lexer = kubvc::algorithm::Lexer::getInstance();
-            static const auto macroController = algorithm::MacroController::getInstance();
-            
-            const auto& expression = model->getExpression();
-            const auto& textBuffer = model->getTextBuffer();
-            auto text = std::string(textBuffer->getBuffer().data());
-            // Replace all macro keywords
-            macroController->appendMacrosToText(text);
-            // Then we can tokenize
-            const auto result = lexer->tokenize(text);
-            
-            if (result.has_value()) {
-                lexer->print(result.value());
-                const auto buildResult = builder->build(expression->getTree(), expression->getVDC(), result.value());
-                expression->setValid(buildResult, !buildResult ? "failed to build ast" : ""); // TODO: Reasons
-                evalExpression(expression, limits);
-                
+        // Queued parse reads text when it's started, so every keystroke doesn't need own pipeline.
+        // User waits for edited expression, so it's parsed before evaluations of other graphs
+        return model->requestParse(limits, [this, &model]() {
+            return parse(model).start(m_taskManager, utility::TaskPriority::Interactive);
+        });
+    }
+
+    inline utility::AsyncTask ExpressionController::parse(std::shared_ptr<ExpressionModel> model) {
+        static const auto builder = kubvc::algorithm::ASTBuilder::getInstance();
+        static const auto macroController = algorithm::MacroController::getInstance();
+        
+        const auto [limits, generation] = model->takeParseRequest();
+        const auto& expression = model->getExpression();
+        const auto& textBuffer = model->getTextBuffer();
+        auto text = std::string(textBuffer->getBuffer().data());
+        // Replace all macro keywords
+        macroController->appendMacrosToText(text);
+        // Then we can tokenize
+        auto& lexer = getWorkerLexer();
+        const auto result = lexer.tokenize(text);
+        if (!result.has_value()) {
+            // Remove model from list 
+            {
                 std::unique_lock lock(m_mutex);
+                std::erase(m_validExpressions, model);
+            }
+            expression->setValid(false, lexer.getLastError());       
+            co_return;
+        }
+
+        lexer.print(result.value());
+
+        // Tree is built as next task, so newer keystroke can cancel pipeline before it
+        co_await utility::reschedule(utility::TaskPriority::Interactive);
+        if (model->isParseStale(generation)) {
+            co_return;
+        }
+
+        const auto buildResult = builder->build(expression->getTree(), expression->getVDC(), result.value());
+        expression->setValid(buildResult, !buildResult ? "failed to build ast" : ""); // TODO: Reasons
+        if (buildResult) {
+            expression->buildSolverDerivative();
+        }
+
+        {
+            std::unique_lock lock(m_mutex);
+            if (std::find(m_validExpressions.begin(), m_validExpressions.end(), model) == m_validExpressions.end()) {
                 m_validExpressions.push_back(model);
-            } else {
-                // Remove model from list 
-                {
-                    std::unique_lock lock(m_mutex);
-                    std::erase(m_validExpressions, model);
-                }
-                const auto lastError = lexer->getLastError();
-                expression->setValid(false, lastError);       
-            }         
-        });
+            }
+        }
+
+        if (model->isParseStale(generation)) {
+            co_return;
+        }
+
+        // Pipeline is finished after evaluation, worker isn't held while it waits
+        co_await evalExpression(expression, limits, utility::TaskPriority::Interactive);
+    }
+
+    inline algorithm::Lexer& ExpressionController::getWorkerLexer() {
+        static thread_local algorithm::Lexer lexer;
+        return lexer;
     }
     
     inline ExpressionController::~ExpressionController() {
@@ -91,25 +140,68 @@ namespace kubvc::math {
 
     inline void ExpressionController::reevaluateAllExpressions(const GraphLimits& limits) {
         std::shared_lock lock(m_mutex);
+        if (m_selected != nullptr && std::find(m_validExpressions.begin(), m_validExpressions.end(), m_selected) != m_validExpressions.end()) {
+            evalExpression(m_selected->getExpression(), limits, utility::TaskPriority::Interactive);
+        }
+
         for (const auto& expr : m_validExpressions) {
-            if (expr) {
-                evalExpression(expr->getExpression(), limits);
+            if (expr && expr != m_selected) {
+                const auto priority = expr->getSettings()->getVisible() ? utility::TaskPriority::Visible : utility::TaskPriority::Background;
+                evalExpression(expr->getExpression(), limits, priority);
             }
         }
     }
 
-    inline void ExpressionController::evalExpression(std::shared_ptr<Expression> expr, const GraphLimits& limits) {
-        std::weak_ptr<Expression> weakExpression = expr;
-        m_taskManager.add([weakExpression, limits]() {
-            if (weakExpression.expired()) {
-                return;
-            }
+    inline utility::TaskFuture ExpressionController::evalExpression(std::shared_ptr<Expression> expr, const GraphLimits& limits, utility::TaskPriority priority) {
+        // Latest request wins: it cancels running evaluation and replaces limits of queued one, 
+        // so each expression has at most one task in queue
+        return expr->requestEval(limits, [this, &expr, priority]() {
+            std::weak_ptr<Expression> weakExpression = expr;
+            return m_taskManager.submit([weakExpression]() {
+                const auto expression = weakExpression.lock();
+                if (expression == nullptr) {
+                    return;
+                }
 
-            const auto lock = weakExpression.lock();
-            lock->eval(limits);
+                const auto [limits, generation] = expression->takeEvalRequest();
+                expression->eval(limits, generation);
+            }, priority);
         });
     }
 
+    inline std::shared_ptr<ExpressionModel> ExpressionController::createDerivative(std::shared_ptr<ExpressionModel> model, const GraphLimits& limits) {
+        static const auto builder = kubvc::algorithm::ASTBuilder::getInstance();
+        KUB_ASSERT(model != nullptr, "Model are nullptr");
+
+        const auto& expression = model->getExpression();
+        const auto root = expression->getTree().getRoot();
+        if (!expression->isValid() || root == nullptr) {
+            KUB_WARN("derivative: expression is not valid");
+            return nullptr;
+        }
+
+        const auto variable = expression->getArgumentVariable();
+        const auto derivative = builder->differentiate(root, variable);
+        const auto text = algorithm::printNode(derivative);
+        if (!text.has_value()) {
+            KUB_WARN("derivative: failed to build derivative");
+            return nullptr;
+        }
+
+        // Derivative is plotted along same variable as source graph
+        const auto derivativeText = (variable == algorithm::DerivativeVariable::X ? "y=" : "x=") + text.value();
+        const auto derivativeModel = create();
+        if (!derivativeModel->getTextBuffer()->setText(derivativeText)) {
+            KUB_WARN("derivative: text is too long {}", derivativeText.size());
+            removeById(derivativeModel->getId());
+            return nullptr;
+        }
+
+        KUB_DEBUG("derivative: {}", derivativeText);
+        parseThenEvaluate(derivativeModel, limits);
+        return derivativeModel;
+    }
+
     inline std::shared_ptr<ExpressionModel> ExpressionController::create() {
         std::unique_lock lock(m_mutex);
         static std::int32_t globalId = 0; 
@@ -128,6 +220,7 @@ namespace kubvc::math {
             m_validExpressions.clear();
         }
         
+        m_tileCache.clear();
         resetSelected();
     }
     
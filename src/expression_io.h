@@ -12,8 +12,8 @@ namespace kubvc::io {
             void saveGraphPoints(std::string_view path, std::shared_ptr<math::ExpressionModel> model);
             // Save all graphs to file 
             void saveGraphs(std::string_view path);
-            // Load and evaluate graphs from file
-            void loadGraphs(std::string_view path);
+            // Load and evaluate graphs from file, future is finished when all loaded graphs are plotted
+            utility::TaskFuture loadGraphs(std::string_view path);
     };
 
     inline void ExpressionIO::saveGraphPoints(std::string_view path, std::shared_ptr<math::ExpressionModel> model) {
@@ -53,11 +53,14 @@ namespace kubvc::io {
         KUB_ASSERT(file.save(path, fileContentBuffer), "failed to save file");  
     }
 
-    inline void ExpressionIO::loadGraphs(std::string_view path) {
+    inline utility::TaskFuture ExpressionIO::loadGraphs(std::string_view path) {
         static const auto controller = math::ExpressionController::getInstance();
         io::FileLoader file;
         const auto result = file.load(path);
         if (result.has_value()) {
+            const auto loadStart = utility::TaskClock::now();
+            utility::TaskGroup group(controller->getTaskManager());
+            std::size_t count = 0;
             const auto& value = result.value();
             for (const auto& str : value | std::views::split('\n') | std::views::filter([](const auto& str) { return !str.empty(); })) {
                 const auto newExpression = controller->create();
@@ -65,11 +68,18 @@ namespace kubvc::io {
                 auto& buffer = newExpression->getTextBuffer()->getBuffer();
                 buffer.insert(buffer.begin(), str.begin(), str.end());
                 // Try to parse it and evaluate 
-                controller->parseThenEvaluate(newExpression, math::GraphLimits::GlobalLimits);
+                group.add(controller->parseThenEvaluate(newExpression, math::GraphLimits::GlobalLimits));
+                ++count;
             }
+
+            return group.then([loadStart, count]() {
+                const std::chrono::duration<double, std::milli> loadTime = utility::TaskClock::now() - loadStart;
+                KUB_DEBUG("io: {} graphs are plotted in {:.3f} ms", count, loadTime.count());
+            }, utility::TaskPriority::Background);
         } else {
             KUB_ERROR("Trying to open a invalid file");
         }
+        return { };
     }
 
 }
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <utility>
 
 #include "expression.h"
 #include "expression_visual_settings.h"
@@ -24,12 +27,44 @@ namespace kubvc::math {
             [[nodiscard]] std::shared_ptr<Expression> getExpression() const { return m_expression; }
             [[nodiscard]] std::shared_ptr<ExpressionVisualSettings> getSettings() const { return m_settings; }            
             [[nodiscard]] std::int32_t getId() const { return m_id; }
+
+            // Store limits of new parse and cancel running one. Task is queued by submit only if parse isn't queued yet, 
+            // otherwise queued task parses latest text with these limits. Returns future of queued parse
+            utility::TaskFuture requestParse(const GraphLimits& limits, const std::function<utility::TaskFuture()>& submit);
+            // Take limits and generation of latest request, it's called by queued parse when it's started
+            [[nodiscard]] std::pair<GraphLimits, std::uint64_t> takeParseRequest();
+            // Text was changed after parse of this generation was started, so its result isn't needed
+            [[nodiscard]] bool isParseStale(std::uint64_t generation) const { 
+                return m_parseGeneration.load(std::memory_order_relaxed) != generation; 
+            }
                 
         private:
             std::int32_t m_id; 
+            GraphLimits m_requestedLimits;
+            // Generation of last requested parse, running parses of older generations are cancelled between stages
+            std::atomic<std::uint64_t> m_parseGeneration = 0;
+            bool m_isParseQueued = false;
+            utility::TaskFuture m_queuedParse;
+            std::mutex m_requestMutex;
 
             std::shared_ptr<ExpressionTextBuffer> m_textBuffer;
             std::shared_ptr<Expression> m_expression;
             std::shared_ptr<ExpressionVisualSettings> m_settings;
     };
+
+    inline utility::TaskFuture ExpressionModel::requestParse(const GraphLimits& limits, const std::function<utility::TaskFuture()>& submit) {
+        std::lock_guard lock(m_requestMutex);
+        m_requestedLimits = limits;
+        m_parseGeneration.fetch_add(1, std::memory_order_relaxed);
+        if (!std::exchange(m_isParseQueued, true)) {
+            m_queuedParse = submit();
+        }
+        return m_queuedParse;
+    }
+
+    inline std::pair<GraphLimits, std::uint64_t> ExpressionModel::takeParseRequest() {
+        std::lock_guard lock(m_requestMutex);
+        m_isParseQueued = false;
+        return { m_requestedLimits, m_parseGeneration.load(std::memory_order_relaxed) };
+    }
 }
\ No newline at end of file
@@ -13,6 +13,8 @@ namespace kubvc::math {
             
             void insertAtCursor(std::string_view text);
             void setCursor(std::size_t cursorPos);
+            // Replace whole text, returns false if text doesn't fit in buffer
+            [[nodiscard]] bool setText(std::string_view text);
 
             [[nodiscard]] std::size_t getCursor()  const { return m_cursor; }
             [[nodiscard]] std::vector<char>& getBuffer() { return m_buffer; } 
@@ -39,6 +41,18 @@ namespace kubvc::math {
         m_buffer.shrink_to_fit();
     }
 
+    inline bool ExpressionTextBuffer::setText(std::string_view text) {
+        // Keep space for null terminator
+        if (text.size() >= m_buffer.size()) {
+            return false;
+        }
+
+        std::fill(m_buffer.begin(), m_buffer.end(), '\0');
+        std::copy(text.begin(), text.end(), m_buffer.begin());
+        m_cursor = text.size();
+        return true;
+    }
+
     inline void ExpressionTextBuffer::setCursor(std::size_t cursorPos) {
         KUB_ASSERT(cursorPos < m_buffer.size(), "Cursor is bigger than text buffer size");
         m_cursor = cursorPos; 
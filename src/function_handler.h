@@ -24,7 +24,12 @@ namespace kubvc::utility
                 return isEmpty();
             }
             constexpr bool isEmpty() const noexcept {
-                return m_functor == nullptr;                
+                return m_functor == nullptr;
+            }
+
+            // Get raw function pointer, used when we need to call handler from generated code
+            constexpr std::decay_t<Func> get() const noexcept {
+                return m_functor;
             }
         private:
             std::decay_t<Func> m_functor;
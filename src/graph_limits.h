@@ -8,11 +8,22 @@ namespace kubvc::math {
         constexpr GraphLimits(const ImPlotRect& rect);
 
         constexpr GraphLimits& operator= (const ImPlotRect& l);
+
+        // Size of viewport in pixels, it's not changed by limits assignment
+        constexpr void setViewportSize(double viewportWidth, double viewportHeight);
+        // Size of one pixel in graph units
+        [[nodiscard]] constexpr double getPixelWidth() const { return (xMax - xMin) / (width > 0.0 ? width : DEFAULT_VIEWPORT_SIZE); }
+        [[nodiscard]] constexpr double getPixelHeight() const { return (yMax - yMin) / (height > 0.0 ? height : DEFAULT_VIEWPORT_SIZE); }
         
+        // Viewport size is unknown before first frame of plot
+        static constexpr auto DEFAULT_VIEWPORT_SIZE = 1024.0;
+
         double xMin = 0.0;
         double xMax = 1.0;
         double yMin = 0.0;
         double yMax = 1.0;        
+        double width = 0.0;
+        double height = 0.0;
         
         // FIXME: Bad
         static GraphLimits GlobalLimits;
@@ -33,4 +44,9 @@ namespace kubvc::math {
         return *this;
     }
 
+    inline constexpr void GraphLimits::setViewportSize(double viewportWidth, double viewportHeight) {
+        width = viewportWidth;
+        height = viewportHeight;
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,469 @@
+#pragma once
+#include "math_base.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <numbers>
+
+namespace kubvc::math {
+    // Closed interval [lower, upper] which contains all values of expression over some region.
+    // Bounds are rounded outward, so real value is never lost. Interval with NaN bounds is empty,
+    // it's a result of expression which isn't defined at any point of region
+    struct Interval {
+        double lower = 0.0;
+        double upper = 0.0;
+
+        [[nodiscard]] bool isEmpty() const { return !(lower <= upper); }
+        [[nodiscard]] bool contains(double value) const { return lower <= value && value <= upper; }
+        [[nodiscard]] static Interval point(double value) { return { value, value }; }
+        [[nodiscard]] static Interval empty() { return { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN() }; }
+        [[nodiscard]] static Interval entire() { return { -std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity() }; }
+    };
+
+    namespace interval {
+        // Max error of library functions in ulps, bounds of function results are widened by it
+        static constexpr std::int32_t FUNCTION_ULPS = 4;
+
+        [[nodiscard]] static inline double down(double value, std::int32_t ulps = 1) {
+            for (std::int32_t i = 0; i < ulps; ++i) {
+                value = std::nextafter(value, -std::numeric_limits<double>::infinity());
+            }
+            return value;
+        }
+
+        [[nodiscard]] static inline double up(double value, std::int32_t ulps = 1) {
+            for (std::int32_t i = 0; i < ulps; ++i) {
+                value = std::nextafter(value, std::numeric_limits<double>::infinity());
+            }
+            return value;
+        }
+
+        // Make interval from bounds in any order. NaN bound means that we can't say anything about values
+        // between them (like inf / inf), so result is whole line
+        [[nodiscard]] static inline Interval hull(double a, double b, std::int32_t ulps = 1) {
+            if (std::isnan(a) || std::isnan(b)) {
+                return Interval::entire();
+            }
+
+            return { down(std::min(a, b), ulps), up(std::max(a, b), ulps) };
+        }
+
+        [[nodiscard]] static inline Interval hull(std::initializer_list<double> values, std::int32_t ulps = 1) {
+            auto lower = std::numeric_limits<double>::infinity();
+            auto upper = -std::numeric_limits<double>::infinity();
+            for (const auto value : values) {
+                if (std::isnan(value)) {
+                    return Interval::entire();
+                }
+
+                lower = std::min(lower, value);
+                upper = std::max(upper, value);
+            }
+
+            return { down(lower, ulps), up(upper, ulps) };
+        }
+
+        // Product where zero wins over infinity, because bound is a limit
+        [[nodiscard]] static inline double multiplyBound(double a, double b) {
+            return a == 0.0 || b == 0.0 ? 0.0 : a * b;
+        }
+
+        // Is some of point + period * k inside interval, slack keeps answer safe if bounds are rounded
+        [[nodiscard]] static inline bool containsPeriodPoint(const Interval& x, double point, double period) {
+            const auto slack = 4.0 * std::numeric_limits<double>::epsilon() * std::max({ 1.0, std::abs(x.lower), std::abs(x.upper) });
+            const auto k = std::ceil((x.lower - slack - point) / period);
+            return point + period * k <= x.upper + slack;
+        }
+
+        // Apply monotonic function, bounds are swapped for decreasing one
+        template<typename Function>
+        [[nodiscard]] static inline Interval monotonic(const Interval& x, Function&& function) {
+            return hull(function(x.lower), function(x.upper), FUNCTION_ULPS);
+        }
+
+        // Limit interval by function domain, returns empty interval if they don't intersect
+        [[nodiscard]] static inline Interval clamp(const Interval& x, double lower, double upper) {
+            if (x.isEmpty() || x.upper < lower || x.lower > upper) {
+                return Interval::empty();
+            }
+
+            return { std::max(x.lower, lower), std::min(x.upper, upper) };
+        }
+    }
+
+    [[nodiscard]] inline Interval operator+(const Interval& left, const Interval& right) {
+        if (left.isEmpty() || right.isEmpty()) {
+            return Interval::empty();
+        }
+
+        return { interval::down(left.lower + right.lower), interval::up(left.upper + right.upper) };
+    }
+
+    [[nodiscard]] inline Interval operator-(const Interval& left, const Interval& right) {
+        if (left.isEmpty() || right.isEmpty()) {
+            return Interval::empty();
+        }
+
+        return { interval::down(left.lower - right.upper), interval::up(left.upper - right.lower) };
+    }
+
+    [[nodiscard]] inline Interval operator*(const Interval& left, const Interval& right) {
+        if (left.isEmpty() || right.isEmpty()) {
+            return Interval::empty();
+        }
+
+        return interval::hull({
+            interval::multiplyBound(left.lower, right.lower), interval::multiplyBound(left.lower, right.upper),
+            interval::multiplyBound(left.upper, right.lower), interval::multiplyBound(left.upper, right.upper)
+        });
+    }
+
+    [[nodiscard]] inline Interval operator-(const Interval& value) {
+        return { -value.upper, -value.lower };
+    }
+
+    // Division is NaN when divisor is too close to zero, so we are skip that points,
+    // but values around zero are still unbounded
+    [[nodiscard]] inline Interval operator/(const Interval& left, const Interval& right) {
+        if (left.isEmpty() || right.isEmpty() || (right.lower == 0.0 && right.upper == 0.0)) {
+            return Interval::empty();
+        }
+
+        if (right.contains(0.0)) {
+            return Interval::entire();
+        }
+
+        return interval::hull({ left.lower / right.lower, left.lower / right.upper, left.upper / right.lower, left.upper / right.upper });
+    }
+
+    namespace interval {
+        // glm::mod: x - y * floor(x / y)
+        [[nodiscard]] static inline Interval mod(const Interval& x, const Interval& y) {
+            if (x.isEmpty() || y.isEmpty()) {
+                return Interval::empty();
+            }
+
+            if (y.contains(0.0)) {
+                return Interval::entire();
+            }
+
+            // Whole x is inside one period of constant divisor
+            if (y.lower == y.upper) {
+                const auto lowerPeriod = std::floor(x.lower / y.lower);
+                if (lowerPeriod == std::floor(x.upper / y.lower)) {
+                    // Error of subtraction depends on size of x, not result
+                    const auto slack = 4.0 * std::numeric_limits<double>::epsilon() * std::max(std::abs(x.lower), std::abs(x.upper));
+                    return hull(x.lower - y.lower * lowerPeriod - slack, x.upper - y.lower * lowerPeriod + slack);
+                }
+            }
+
+            // Result has same sign as divisor and it's smaller than divisor
+            return y.lower > 0.0 ? Interval { 0.0, y.upper } : Interval { y.lower, 0.0 };
+        }
+
+        [[nodiscard]] static inline Interval integerPower(const Interval& x, double n) {
+            if (n == 0.0) {
+                return Interval::point(1.0);
+            }
+
+            const auto lower = std::pow(x.lower, n);
+            const auto upper = std::pow(x.upper, n);
+            if (n < 0.0 && x.contains(0.0)) {
+                return Interval::entire();
+            }
+
+            // Even power has minimum at zero
+            if (std::fmod(n, 2.0) == 0.0 && x.contains(0.0)) {
+                return { 0.0, up(std::max(lower, upper), FUNCTION_ULPS) };
+            }
+
+            return hull(lower, upper, FUNCTION_ULPS);
+        }
+
+        // glm::pow: negative base is defined only for integer exponent
+        [[nodiscard]] static inline Interval pow(const Interval& x, const Interval& y) {
+            if (x.isEmpty() || y.isEmpty()) {
+                return Interval::empty();
+            }
+
+            if (y.lower == y.upper && std::floor(y.lower) == y.lower) {
+                return integerPower(x, y.lower);
+            }
+
+            // Negative base gives values only at integer exponents, we don't track them
+            if (x.lower < 0.0 && std::floor(y.upper) >= y.lower) {
+                return Interval::entire();
+            }
+
+            const auto base = clamp(x, 0.0, std::numeric_limits<double>::infinity());
+            if (base.isEmpty()) {
+                return Interval::empty();
+            }
+
+            // Power is monotonic by each argument for positive base, so extremes are in corners
+            return hull({
+                std::pow(base.lower, y.lower), std::pow(base.lower, y.upper),
+                std::pow(base.upper, y.lower), std::pow(base.upper, y.upper)
+            }, FUNCTION_ULPS);
+        }
+
+        [[nodiscard]] static inline Interval sin(const Interval& x) {
+            constexpr auto PI = std::numbers::pi_v<double>;
+            if (x.isEmpty()) {
+                return Interval::empty();
+            }
+
+            if (x.upper - x.lower >= 2.0 * PI) {
+                return { -1.0, 1.0 };
+            }
+
+            auto result = monotonic(x, [](double value) { return glm::sin(value); });
+            if (containsPeriodPoint(x, PI * 0.5, 2.0 * PI)) {
+                result.upper = 1.0;
+            }
+            if (containsPeriodPoint(x, -PI * 0.5, 2.0 * PI)) {
+                result.lower = -1.0;
+            }
+            return { std::max(result.lower, -1.0), std::min(result.upper, 1.0) };
+        }
+
+        [[nodiscard]] static inline Interval cos(const Interval& x) {
+            constexpr auto PI = std::numbers::pi_v<double>;
+            if (x.isEmpty()) {
+                return Interval::empty();
+            }
+
+            if (x.upper - x.lower >= 2.0 * PI) {
+                return { -1.0, 1.0 };
+            }
+
+            auto result = monotonic(x, [](double value) { return glm::cos(value); });
+            if (containsPeriodPoint(x, 0.0, 2.0 * PI)) {
+                result.upper = 1.0;
+            }
+            if (containsPeriodPoint(x, PI, 2.0 * PI)) {
+                result.lower = -1.0;
+            }
+            return { std::max(result.lower, -1.0), std::min(result.upper, 1.0) };
+        }
+
+        // Function which is monotonic between poles at point + period * k
+        template<typename Function>
+        [[nodiscard]] static inline Interval periodicWithPoles(const Interval& x, double pole, Function&& function) {
+            constexpr auto PI = std::numbers::pi_v<double>;
+            if (x.isEmpty()) {
+                return Interval::empty();
+            }
+
+            if (x.upper - x.lower >= PI || containsPeriodPoint(x, pole, PI)) {
+                return Interval::entire();
+            }
+
+            return monotonic(x, function);
+        }
+
+        [[nodiscard]] static inline Interval tg(const Interval& x) {
+            return periodicWithPoles(x, std::numbers::pi_v<double> * 0.5, [](double value) { return glm::tan(value); });
+        }
+
+        [[nodiscard]] static inline Interval ctg(const Interval& x) {
+            return periodicWithPoles(x, 0.0, functions::real::ctg);
+        }
+
+        // Function which is monotonic at both sides of pole at zero, like 1 / x
+        template<typename Function>
+        [[nodiscard]] static inline Interval withPoleAtZero(const Interval& x, Function&& function) {
+            if (x.isEmpty()) {
+                return Interval::empty();
+            }
+
+            if (x.contains(0.0)) {
+                return Interval::entire();
+            }
+
+            return monotonic(x, function);
+        }
+
+        // Even function which is monotonic by absolute value of argument
+        template<typename Function>
+        [[nodiscard]] static inline Interval even(const Interval& x, Function&& function) {
+            if (x.isEmpty()) {
+                return Interval::empty();
+            }
+
+            if (!x.contains(0.0)) {
+                return monotonic(x, function);
+            }
+
+            return hull({ function(0.0), function(x.lower), function(x.upper) }, FUNCTION_ULPS);
+        }
+
+        [[nodiscard]] static inline Interval sh(const Interval& x) {
+            return x.isEmpty() ? Interval::empty() : monotonic(x, functions::real::sh);
+        }
+
+        [[nodiscard]] static inline Interval ch(const Interval& x) {
+            return even(x, functions::real::ch);
+        }
+
+        [[nodiscard]] static inline Interval th(const Interval& x) {
+            return x.isEmpty() ? Interval::empty() : monotonic(x, functions::real::th);
+        }
+
+        [[nodiscard]] static inline Interval cth(const Interval& x) {
+            return withPoleAtZero(x, functions::real::cth);
+        }
+
+        [[nodiscard]] static inline Interval sch(const Interval& x) {
+            return even(x, functions::real::sch);
+        }
+
+        [[nodiscard]] static inline Interval csch(const Interval& x) {
+            return withPoleAtZero(x, functions::real::csch);
+        }
+
+        [[nodiscard]] static inline Interval arccos(const Interval& x) {
+            const auto domain = clamp(x, -1.0, 1.0);
+            return domain.isEmpty() ? domain : monotonic(domain, [](double value) { return glm::acos(value); });
+        }
+
+        [[nodiscard]] static inline Interval arcsin(const Interval& x) {
+            const auto domain = clamp(x, -1.0, 1.0);
+            return domain.isEmpty() ? domain : monotonic(domain, [](double value) { return glm::asin(value); });
+        }
+
+        [[nodiscard]] static inline Interval arctg(const Interval& x) {
+            return x.isEmpty() ? Interval::empty() : monotonic(x, [](double value) { return glm::atan(value); });
+        }
+
+        [[nodiscard]] static inline Interval arcctg(const Interval& x) {
+            return x.isEmpty() ? Interval::empty() : monotonic(x, functions::real::arcctg);
+        }
+
+        [[nodiscard]] static inline Interval abs(const Interval& x) {
+            return even(x, [](double value) { return glm::abs(value); });
+        }
+
+        [[nodiscard]] static inline Interval exp(const Interval& x) {
+            return x.isEmpty() ? Interval::empty() : monotonic(x, [](double value) { return glm::exp(value); });
+        }
+
+        [[nodiscard]] static inline Interval sqrt(const Interval& x) {
+            const auto domain = clamp(x, 0.0, std::numeric_limits<double>::infinity());
+            return domain.isEmpty() ? domain : monotonic(domain, [](double value) { return glm::sqrt(value); });
+        }
+
+        [[nodiscard]] static inline Interval norm(const Interval& x) {
+            return even(x, [](double value) { return value * value; });
+        }
+
+        // std::arg of real number is 0 for positive and pi for negative
+        [[nodiscard]] static inline Interval arg(const Interval& x) {
+            constexpr auto PI = std::numbers::pi_v<double>;
+            if (x.isEmpty()) {
+                return Interval::empty();
+            }
+
+            if (x.lower > 0.0) {
+                return Interval::point(0.0);
+            }
+
+            if (x.upper < 0.0) {
+                return { down(PI), up(PI) };
+            }
+
+            return { 0.0, up(PI) };
+        }
+
+        [[nodiscard]] static inline Interval ln(const Interval& x) {
+            const auto domain = clamp(x, 0.0, std::numeric_limits<double>::infinity());
+            return domain.isEmpty() ? domain : monotonic(domain, [](double value) { return glm::log(value); });
+        }
+
+        [[nodiscard]] static inline Interval log10(const Interval& x) {
+            const auto domain = clamp(x, 0.0, std::numeric_limits<double>::infinity());
+            return domain.isEmpty() ? domain : monotonic(domain, [](double value) { return std::log10(value); });
+        }
+
+        [[nodiscard]] static inline Interval log2(const Interval& x) {
+            const auto domain = clamp(x, 0.0, std::numeric_limits<double>::infinity());
+            return domain.isEmpty() ? domain : monotonic(domain, [](double value) { return glm::log2(value); });
+        }
+
+        [[nodiscard]] static inline Interval round(const Interval& x) {
+            return x.isEmpty() ? Interval::empty() : Interval { glm::round(x.lower), glm::round(x.upper) };
+        }
+
+        // tgamma(x + 1), gamma has poles at non positive integers and minimum at 1.46163...
+        [[nodiscard]] static inline Interval fact(const Interval& x) {
+            constexpr auto GAMMA_MIN_ARGUMENT = 1.4616321449683623;
+            constexpr auto GAMMA_MIN_VALUE = 0.8856031944108887;
+            if (x.isEmpty()) {
+                return Interval::empty();
+            }
+
+            const auto argument = x + Interval::point(1.0);
+            if (argument.lower <= 0.0) {
+                return Interval::entire();
+            }
+
+            const auto result = monotonic(x, functions::real::fact);
+            if (argument.contains(GAMMA_MIN_ARGUMENT)) {
+                return { down(GAMMA_MIN_VALUE, FUNCTION_ULPS), result.upper };
+            }
+            return result;
+        }
+
+        // Random value in [-|x|, |x|]
+        [[nodiscard]] static inline Interval rnd(const Interval& x) {
+            if (x.isEmpty()) {
+                return Interval::empty();
+            }
+
+            const auto bound = std::max(std::abs(x.lower), std::abs(x.upper));
+            return { -bound, bound };
+        }
+    }
+
+    namespace containers {
+        using IntervalFunctionHandler = utility::FunctionHandler<Interval(const Interval&)>;
+
+        // Interval versions of functions from Functions list
+        static constexpr std::initializer_list<std::pair<std::string_view, IntervalFunctionHandler>> IntervalFunctions = {
+                { "sin", interval::sin },
+                { "cos", interval::cos },
+                { "tg",  interval::tg },
+                { "ctg", interval::ctg },
+
+                { "sh", interval::sh },
+                { "ch", interval::ch },
+                { "th", interval::th },
+                { "cth", interval::cth },
+                { "sch", interval::sch },
+                { "csch", interval::csch },
+
+                { "arccos", interval::arccos },
+                { "arcsin", interval::arcsin },
+                { "arctg",  interval::arctg },
+                { "arcctg", interval::arcctg },
+
+                { "abs",   interval::abs },
+                { "exp",   interval::exp },
+                { "sqrt",  interval::sqrt },
+                { "norm",  interval::norm },
+                { "arg",   interval::arg },
+
+                { "ln",    interval::ln },
+                { "log10", interval::log10 },
+                { "log2",  interval::log2 },
+
+                { "round", interval::round },
+                { "fact", interval::fact },
+
+                { "rnd", interval::rnd }
+        };
+    }
+}
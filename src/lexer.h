@@ -15,6 +15,7 @@
 #include <algorithm>
 #include <optional>
 #include <stack>
+#include <charconv>
 
 #ifdef KUB_ENABLE_LEXER_DEBUG_LOG
     #define KUB_LEXER_DEBUG(fmt, ...) KUB_DEBUG(fmt, ##__VA_ARGS__)
@@ -39,6 +40,8 @@ namespace kubvc::algorithm {
 
         Types type;
         std::string value;
+        // Parsed value of number token, so builder doesn't parse text again
+        double number = 0.0;
     }; 
     
     class Lexer : public utility::Singleton<Lexer> {
@@ -307,10 +310,18 @@ namespace kubvc::algorithm {
                 isOperatorOpen = false;
                 if (result.has_value()) {
                     const auto number = result.value();
+                    double numberValue = 0.0;
+                    const auto [end, error] = std::from_chars(number.data(), number.data() + number.size(), numberValue);
+                    if (error != std::errc() || end != number.data() + number.size()) {
+                        saveLastError("failed to parse number: invalid numeric format '{}' at position {}", number, pos);
+                        return std::nullopt;
+                    }
+
                     pos += number.size(); 
                     const auto token = Token {
                         Token::Types::Number,
                         number,
+                        numberValue
                     };
                     tokens.push_back(token);
                     KUB_LEXER_DEBUG("[tokenize] parserd number is {}", number);
@@ -328,9 +339,11 @@ namespace kubvc::algorithm {
                     const auto constResult = utility::container::get(math::containers::Constants, std::string_view { word.data(), wordSize });
                     if (constResult.has_value()) {
                         KUB_LEXER_DEBUG("[tokenize] it's a constant");
+                        // Keep name as text, value is passed with full precision
                         const auto token = Token {
                             Token::Types::Number,
-                            std::to_string(constResult.value()),
+                            word,
+                            constResult.value()
                         };   
                         tokens.push_back(token);
                         pos += wordSize;
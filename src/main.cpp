@@ -4,6 +4,7 @@
 #include "gui.h"
 #include "expression.h"
 #include "logger.h"
+#include "simd_kernels.h"
 
 #include "editor/editor.h"
 #include "editor/editor_menu_bar.h"
@@ -24,6 +25,9 @@ int main() {
 
         const auto gui = kubvc::render::GUI::getInstance();
         gui->init();
+
+        // Select vector kernels for current cpu before first expression is evaluated
+        [[maybe_unused]] const auto& kernels = kubvc::algorithm::simd::getKernelTable();
         
         const auto editor = kubvc::editor::Editor::getInstance();
         auto menuBar = kubvc::editor::EditorMenuBar { };
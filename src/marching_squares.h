@@ -0,0 +1,479 @@
+#pragma once
+#include <glm/glm.hpp>
+#include "graph_limits.h"
+#include "interval.h"
+#include "task_manager.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace kubvc::math::contour {
+    using Polyline = std::vector<glm::dvec2>;
+
+    // Residual of implicit curve f(x, y) = 0
+    struct Residual {
+        // Calculate for arrays of points, all spans have same size
+        std::function<void(std::span<const double> xs, std::span<const double> ys, std::span<double> out)> batch;
+        // Contains all values of residual in region, it's used to skip tiles which curve doesn't cross
+        std::function<Interval(const Interval& x, const Interval& y)> interval;
+    };
+
+    struct ContourStats {
+        std::uint32_t tiles = 0;
+        // Tiles which are taken from storage
+        std::uint32_t reusedTiles = 0;
+        // Tiles which are skipped by interval calculation
+        std::uint32_t prunedTiles = 0;
+        // Cells which are calculated on grid, others are skipped by interval calculation or reused
+        std::uint32_t cells = 0;
+        // Calculations of residual for grid and edge refinement
+        std::uint32_t evaluations = 0;
+        std::uint32_t segments = 0;
+        std::uint32_t polylines = 0;
+    };
+
+    // Size of grid cell in pixels, real size is rounded to power of two in graph units
+    static constexpr auto CELL_PIXELS = 4.0;
+    static constexpr std::int32_t MIN_CELLS = 16;
+    static constexpr std::int32_t MAX_CELLS = 512;
+    // Tile is square of cells which is processed by one task,
+    // tiles are placed on global lattice, so only tiles at border of view are new when it's panned
+    static constexpr std::int32_t TILE_CELLS = 16;
+    // Smallest block of cells which is checked by interval calculation
+    static constexpr std::int32_t BLOCK_CELLS = 8;
+    // False position steps for each crossed edge
+    static constexpr std::int32_t REFINE_ITERATIONS = 3;
+
+    struct TraceParams {
+        // Size of grid cell in pixels, bigger cells are used for coarse pass
+        double cellPixels = CELL_PIXELS;
+        // Tiles which aren't started yet are skipped if it returns true
+        std::function<bool()> isCancelled;
+    };
+
+    // Global index of tile, cell size of its grid is 2^level along axis
+    struct TileIndex {
+        std::int32_t levelX = 0;
+        std::int32_t levelY = 0;
+        std::int64_t x = 0;
+        std::int64_t y = 0;
+    };
+
+    // Part of curve in one cell, its ends are keyed by crossed edges
+    struct Segment {
+        std::uint64_t from;
+        std::uint64_t to;
+        glm::dvec2 a;
+        glm::dvec2 b;
+    };
+
+    // Segments of one tile, keys of edges are numbered on grid of tile
+    struct TileResult {
+        std::vector<Segment> segments;
+        std::uint32_t cells = 0;
+        std::uint32_t evaluations = 0;
+    };
+
+    // Tiles which are calculated before, trace takes tiles from find and gives new ones to store.
+    // Store is called from workers of task manager
+    struct TileStorage {
+        std::function<std::shared_ptr<const TileResult>(const TileIndex& index)> find;
+        std::function<void(const TileIndex& index, std::shared_ptr<const TileResult> tile)> store;
+    };
+
+    namespace details {
+        struct Grid {
+            // Size of cell, it's power of two, so nodes of grid are calculated exactly
+            double cellWidth;
+            double cellHeight;
+            // Global index of first node
+            std::int64_t i0;
+            std::int64_t j0;
+            std::int32_t columns;
+            std::int32_t rows;
+
+            [[nodiscard]] double x(std::int32_t i) const { return static_cast<double>(i0 + i) * cellWidth; }
+            [[nodiscard]] double y(std::int32_t j) const { return static_cast<double>(j0 + j) * cellHeight; }
+
+            // Edge keys are same for both cells which share edge, so segments are joined by them
+            [[nodiscard]] std::uint64_t horizontalEdge(std::int32_t i, std::int32_t j) const {
+                return (static_cast<std::uint64_t>(j) * (columns + 1) + i) * 2;
+            }
+
+            [[nodiscard]] std::uint64_t verticalEdge(std::int32_t i, std::int32_t j) const {
+                return (static_cast<std::uint64_t>(j) * (columns + 1) + i) * 2 + 1;
+            }
+        };
+
+        [[nodiscard]] inline bool isCrossed(double fa, double fb) {
+            return !std::isnan(fa) && !std::isnan(fb) && ((fa > 0.0) != (fb > 0.0));
+        }
+
+        // Crossing of cell edge which is refined by false position with Illinois modification
+        struct Crossing {
+            glm::dvec2 a;
+            glm::dvec2 b;
+            double fa;
+            double fb;
+            // Residual can't grow near root, otherwise it's a pole like in tg(x) and not a curve
+            double limit;
+            // Refined point, it's NaN if crossing is rejected
+            glm::dvec2* point;
+            std::int32_t side = 0;
+            bool isDone = false;
+        };
+
+        // All crossings of tile are refined together, so each step is one batch calculation
+        inline void refineCrossings(const Residual& f, std::span<Crossing> crossings, std::uint32_t& evaluations) {
+            std::vector<double> xs(crossings.size());
+            std::vector<double> ys(crossings.size());
+            std::vector<double> values(crossings.size());
+            for (auto& crossing : crossings) {
+                *crossing.point = glm::mix(crossing.a, crossing.b, crossing.fa / (crossing.fa - crossing.fb));
+            }
+
+            for (std::int32_t i = 0; i < REFINE_ITERATIONS; ++i) {
+                for (std::size_t k = 0; k < crossings.size(); ++k) {
+                    xs[k] = crossings[k].point->x;
+                    ys[k] = crossings[k].point->y;
+                }
+
+                f.batch(xs, ys, values);
+                evaluations += static_cast<std::uint32_t>(crossings.size());
+                for (std::size_t k = 0; k < crossings.size(); ++k) {
+                    auto& crossing = crossings[k];
+                    const auto value = values[k];
+                    if (crossing.isDone || std::isnan(crossing.point->x)) {
+                        continue;
+                    }
+
+                    if (std::isnan(value) || std::abs(value) > crossing.limit) {
+                        *crossing.point = { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN() };
+                        continue;
+                    }
+
+                    if (value == 0.0) {
+                        crossing.isDone = true;
+                        continue;
+                    }
+
+                    if ((value > 0.0) == (crossing.fa > 0.0)) {
+                        crossing.a = *crossing.point;
+                        crossing.fa = value;
+                        crossing.fb *= crossing.side == -1 ? 0.5 : 1.0;
+                        crossing.side = -1;
+                    } else {
+                        crossing.b = *crossing.point;
+                        crossing.fb = value;
+                        crossing.fa *= crossing.side == 1 ? 0.5 : 1.0;
+                        crossing.side = 1;
+                    }
+
+                    *crossing.point = glm::mix(crossing.a, crossing.b, crossing.fa / (crossing.fa - crossing.fb));
+                }
+            }
+        }
+
+        // Trace curve in block of cells
+        inline void processBlock(const Residual& f, const Grid& grid, std::int32_t i0, std::int32_t j0, std::int32_t columns, std::int32_t rows, TileResult& result) {
+            // Corners of block cells, border rows and columns are calculated by neighbour blocks too
+            const auto stride = columns + 1;
+            std::vector<double> values(static_cast<std::size_t>(stride) * (rows + 1));
+            std::vector<double> xs(stride);
+            std::vector<double> ys(stride);
+            for (std::int32_t i = 0; i <= columns; ++i) {
+                xs[i] = grid.x(i0 + i);
+            }
+
+            for (std::int32_t j = 0; j <= rows; ++j) {
+                std::ranges::fill(ys, grid.y(j0 + j));
+                f.batch(xs, ys, std::span(values).subspan(static_cast<std::size_t>(j) * stride, stride));
+            }
+            result.evaluations += static_cast<std::uint32_t>(values.size());
+            result.cells += static_cast<std::uint32_t>(columns * rows);
+
+            const auto at = [&](std::int32_t i, std::int32_t j) { return values[static_cast<std::size_t>(j) * stride + i]; };
+            const auto point = [&](std::int32_t i, std::int32_t j) { return glm::dvec2 { xs[i], grid.y(j0 + j) }; };
+
+            // Crossings of edges, each edge is refined once and shared by both its cells
+            const glm::dvec2 NO_CROSSING = { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN() };
+            std::vector<glm::dvec2> horizontal(static_cast<std::size_t>(columns) * (rows + 1), NO_CROSSING);
+            std::vector<glm::dvec2> vertical(static_cast<std::size_t>(stride) * rows, NO_CROSSING);
+            std::vector<Crossing> crossings;
+            crossings.reserve(static_cast<std::size_t>(columns + rows) * 2);
+            const auto addCrossing = [&](std::int32_t i, std::int32_t j, std::int32_t ni, std::int32_t nj, glm::dvec2& target) {
+                const auto fa = at(i, j);
+                const auto fb = at(ni, nj);
+                if (isCrossed(fa, fb)) {
+                    crossings.push_back({ point(i, j), point(ni, nj), fa, fb, std::max(std::abs(fa), std::abs(fb)), &target });
+                }
+            };
+
+            for (std::int32_t j = 0; j <= rows; ++j) {
+                for (std::int32_t i = 0; i <= columns; ++i) {
+                    if (i < columns) {
+                        addCrossing(i, j, i + 1, j, horizontal[static_cast<std::size_t>(j) * columns + i]);
+                    }
+
+                    if (j < rows) {
+                        addCrossing(i, j, i, j + 1, vertical[static_cast<std::size_t>(j) * stride + i]);
+                    }
+                }
+            }
+            refineCrossings(f, crossings, result.evaluations);
+
+            // Edges of cell are numbered as bottom, right, top, left.
+            // Each case has pairs of edges which are joined by segments, saddle cases are resolved by value in center of cell
+            static constexpr std::array<std::array<std::int8_t, 4>, 16> CASES = {{
+                { -1, -1, -1, -1 }, { 3, 0, -1, -1 }, { 0, 1, -1, -1 }, { 3, 1, -1, -1 },
+                { 1, 2, -1, -1 }, { 3, 0, 1, 2 }, { 0, 2, -1, -1 }, { 3, 2, -1, -1 },
+                { 2, 3, -1, -1 }, { 2, 0, -1, -1 }, { 0, 1, 2, 3 }, { 2, 1, -1, -1 },
+                { 1, 3, -1, -1 }, { 1, 0, -1, -1 }, { 0, 3, -1, -1 }, { -1, -1, -1, -1 }
+            }};
+
+            for (std::int32_t j = 0; j < rows; ++j) {
+                for (std::int32_t i = 0; i < columns; ++i) {
+                    const std::array<double, 4> corners = { at(i, j), at(i + 1, j), at(i + 1, j + 1), at(i, j + 1) };
+                    auto index = (corners[0] > 0.0 ? 1 : 0) | (corners[1] > 0.0 ? 2 : 0) | (corners[2] > 0.0 ? 4 : 0) | (corners[3] > 0.0 ? 8 : 0);
+                    // Cells with NaN corners are outside of expression domain
+                    if (index == 0 || index == 15 || std::ranges::any_of(corners, [](double value) { return std::isnan(value); })) {
+                        continue;
+                    }
+
+                    if (index == 5 || index == 10) {
+                        // Positive center joins positive corners, so negative ones are cut off instead
+                        const auto center = (corners[0] + corners[1] + corners[2] + corners[3]) * 0.25;
+                        if (center > 0.0) {
+                            index = 15 - index;
+                        }
+                    }
+
+                    const std::array<glm::dvec2, 4> crossings = {
+                        horizontal[static_cast<std::size_t>(j) * columns + i],
+                        vertical[static_cast<std::size_t>(j) * stride + i + 1],
+                        horizontal[static_cast<std::size_t>(j + 1) * columns + i],
+                        vertical[static_cast<std::size_t>(j) * stride + i]
+                    };
+
+                    // Rejected crossing means pole inside of cell, whole cell is skipped
+                    const auto isRejected = [](const glm::dvec2& crossing) { return std::isnan(crossing.x); };
+                    const auto& edges = CASES[index];
+                    if (std::ranges::any_of(edges, [&](std::int8_t edge) { return edge >= 0 && isRejected(crossings[edge]); })) {
+                        continue;
+                    }
+
+                    const auto gi = i0 + i;
+                    const auto gj = j0 + j;
+                    const std::array<std::uint64_t, 4> keys = {
+                        grid.horizontalEdge(gi, gj),
+                        grid.verticalEdge(gi + 1, gj),
+                        grid.horizontalEdge(gi, gj + 1),
+                        grid.verticalEdge(gi, gj)
+                    };
+
+                    for (std::size_t k = 0; k < edges.size() && edges[k] >= 0; k += 2) {
+                        result.segments.push_back({ keys[edges[k]], keys[edges[k + 1]], crossings[edges[k]], crossings[edges[k + 1]] });
+                    }
+                }
+            }
+        }
+
+        // Region is split to quarters until interval calculation proves that curve doesn't cross them,
+        // so only blocks near curve are calculated on grid
+        inline void processRegion(const Residual& f, const Grid& grid, std::int32_t i0, std::int32_t j0, std::int32_t columns, std::int32_t rows, TileResult& result) {
+            const auto residualRange = f.interval({ grid.x(i0), grid.x(i0 + columns) }, { grid.y(j0), grid.y(j0 + rows) });
+            if (!residualRange.contains(0.0)) {
+                return;
+            }
+
+            if (columns <= BLOCK_CELLS && rows <= BLOCK_CELLS) {
+                processBlock(f, grid, i0, j0, columns, rows, result);
+                return;
+            }
+
+            const auto leftColumns = columns > BLOCK_CELLS ? columns / 2 : columns;
+            const auto bottomRows = rows > BLOCK_CELLS ? rows / 2 : rows;
+            processRegion(f, grid, i0, j0, leftColumns, bottomRows, result);
+            if (leftColumns < columns) {
+                processRegion(f, grid, i0 + leftColumns, j0, columns - leftColumns, bottomRows, result);
+            }
+
+            if (bottomRows < rows) {
+                processRegion(f, grid, i0, j0 + bottomRows, leftColumns, rows - bottomRows, result);
+                if (leftColumns < columns) {
+                    processRegion(f, grid, i0 + leftColumns, j0 + bottomRows, columns - leftColumns, rows - bottomRows, result);
+                }
+            }
+        }
+
+        // Tile has its own grid, so keys of its segments don't depend on view and it can be reused by other traces
+        inline void processTile(const Residual& f, double cellWidth, double cellHeight, std::int64_t tileX, std::int64_t tileY, TileResult& result) {
+            const Grid grid = { cellWidth, cellHeight, tileX * TILE_CELLS, tileY * TILE_CELLS, TILE_CELLS, TILE_CELLS };
+            processRegion(f, grid, 0, 0, TILE_CELLS, TILE_CELLS, result);
+        }
+
+        // Convert edge key of tile grid to key of grid of whole trace
+        [[nodiscard]] inline std::uint64_t toTraceEdge(std::uint64_t key, std::int64_t tileX, std::int64_t tileY, std::int64_t columns) {
+            const auto index = static_cast<std::int64_t>(key / 2);
+            const auto i = tileX * TILE_CELLS + index % (TILE_CELLS + 1);
+            const auto j = tileY * TILE_CELLS + index / (TILE_CELLS + 1);
+            return static_cast<std::uint64_t>(j * (columns + 1) + i) * 2 + key % 2;
+        }
+
+        // Join segments which share edges to polylines
+        [[nodiscard]] inline std::vector<Polyline> joinSegments(std::span<const Segment> segments) {
+            // Every edge is shared by two cells at most, so after sort by edge key segments of same edge are neighbours
+            std::vector<std::pair<std::uint64_t, std::int32_t>> ends;
+            ends.reserve(segments.size() * 2);
+            for (std::int32_t i = 0; i < static_cast<std::int32_t>(segments.size()); ++i) {
+                ends.push_back({ segments[i].from, i });
+                ends.push_back({ segments[i].to, i });
+            }
+            std::ranges::sort(ends);
+
+            const auto findNext = [&](std::uint64_t key, std::int32_t segment) {
+                auto it = std::ranges::lower_bound(ends, std::pair { key, std::numeric_limits<std::int32_t>::min() });
+                for (; it != ends.end() && it->first == key; ++it) {
+                    if (it->second != segment) {
+                        return it->second;
+                    }
+                }
+                return -1;
+            };
+
+            std::vector<bool> visited(segments.size(), false);
+            // Walk from segment through edge key and add far points of next segments to line
+            const auto walk = [&](std::int32_t segment, std::uint64_t key, Polyline& line) {
+                while (true) {
+                    const auto next = findNext(key, segment);
+                    if (next == -1 || visited[next]) {
+                        return;
+                    }
+
+                    visited[next] = true;
+                    const auto& nextSegment = segments[next];
+                    const auto isFrom = nextSegment.from == key;
+                    line.push_back(isFrom ? nextSegment.b : nextSegment.a);
+
+                    segment = next;
+                    key = isFrom ? nextSegment.to : nextSegment.from;
+                }
+            };
+
+            std::vector<Polyline> polylines;
+            for (std::int32_t i = 0; i < static_cast<std::int32_t>(segments.size()); ++i) {
+                if (visited[i]) {
+                    continue;
+                }
+
+                visited[i] = true;
+                Polyline forward = { segments[i].a, segments[i].b };
+                walk(i, segments[i].to, forward);
+                Polyline backward;
+                walk(i, segments[i].from, backward);
+                if (!backward.empty()) {
+                    std::ranges::reverse(backward);
+                    backward.insert(backward.end(), forward.begin(), forward.end());
+                    forward = std::move(backward);
+                }
+                polylines.push_back(std::move(forward));
+            }
+
+            return polylines;
+        }
+    }
+
+    // Trace curve f(x, y) = 0 in limits by marching squares. Grid is split to tiles which are calculated on workers of task manager,
+    // every crossing of cell edge is refined by few calculations of residual. Tiles are placed on global lattice, 
+    // so tiles of previous traces of same residual are taken from storage. If trace is cancelled,
+    // tiles are skipped and not stored after cancel, so result is incomplete and it shouldn't be used
+    [[nodiscard]] inline std::vector<Polyline> trace(const Residual& f, const GraphLimits& limits, utility::TaskManager& taskManager, 
+        const TileStorage& storage, const TraceParams& params, ContourStats& stats) {
+        stats = { };
+        if (!(limits.xMax > limits.xMin) || !(limits.yMax > limits.yMin) || !std::isfinite(limits.xMax - limits.xMin) || !std::isfinite(limits.yMax - limits.yMin)) {
+            return { };
+        }
+
+        // Cell size is rounded to power of two, so it's same while zoom is changed less than in sqrt(2) times
+        const auto levelAlong = [&params](double range, double pixels) {
+            const auto size = pixels > 0.0 ? pixels : GraphLimits::DEFAULT_VIEWPORT_SIZE;
+            const auto cells = std::clamp(size / params.cellPixels, static_cast<double>(MIN_CELLS), static_cast<double>(MAX_CELLS));
+            return static_cast<std::int32_t>(std::round(std::log2(range / cells)));
+        };
+
+        const auto levelX = levelAlong(limits.xMax - limits.xMin, limits.width);
+        const auto levelY = levelAlong(limits.yMax - limits.yMin, limits.height);
+        const auto cellWidth = std::ldexp(1.0, levelX);
+        const auto cellHeight = std::ldexp(1.0, levelY);
+        const auto tileX = static_cast<std::int64_t>(std::floor(limits.xMin / (cellWidth * TILE_CELLS)));
+        const auto tileY = static_cast<std::int64_t>(std::floor(limits.yMin / (cellHeight * TILE_CELLS)));
+        const auto tilesX = std::max<std::int64_t>(static_cast<std::int64_t>(std::ceil(limits.xMax / (cellWidth * TILE_CELLS))) - tileX, 1);
+        const auto tilesY = std::max<std::int64_t>(static_cast<std::int64_t>(std::ceil(limits.yMax / (cellHeight * TILE_CELLS))) - tileY, 1);
+        const auto indexOf = [&](std::size_t tile) {
+            return TileIndex { levelX, levelY, tileX + static_cast<std::int64_t>(tile) % tilesX, tileY + static_cast<std::int64_t>(tile) / tilesX };
+        };
+
+        std::vector<std::shared_ptr<const TileResult>> tiles(static_cast<std::size_t>(tilesX * tilesY));
+        std::vector<std::size_t> missing;
+        for (std::size_t tile = 0; tile < tiles.size(); ++tile) {
+            tiles[tile] = storage.find ? storage.find(indexOf(tile)) : nullptr;
+            if (tiles[tile] == nullptr) {
+                missing.push_back(tile);
+            }
+        }
+
+        taskManager.parallelFor(missing.size(), 1, [&](std::size_t begin, std::size_t end) {
+            for (auto k = begin; k < end; ++k) {
+                if (params.isCancelled && params.isCancelled()) {
+                    return;
+                }
+
+                const auto tile = missing[k];
+                const auto index = indexOf(tile);
+                auto result = std::make_shared<TileResult>();
+                details::processTile(f, cellWidth, cellHeight, index.x, index.y, *result);
+                // Residual can be changed by the time trace is cancelled, so tile isn't stored
+                if (storage.store && !(params.isCancelled && params.isCancelled())) {
+                    storage.store(index, result);
+                }
+                tiles[tile] = std::move(result);
+            }
+        });
+
+        if (params.isCancelled && params.isCancelled()) {
+            return { };
+        }
+
+        std::vector<Segment> segments;
+        stats.tiles = static_cast<std::uint32_t>(tiles.size());
+        stats.reusedTiles = static_cast<std::uint32_t>(tiles.size() - missing.size());
+        for (const auto tile : missing) {
+            stats.cells += tiles[tile]->cells;
+            stats.evaluations += tiles[tile]->evaluations;
+        }
+
+        for (std::size_t tile = 0; tile < tiles.size(); ++tile) {
+            const auto& result = *tiles[tile];
+            const auto i = static_cast<std::int64_t>(tile) % tilesX;
+            const auto j = static_cast<std::int64_t>(tile) / tilesX;
+            stats.prunedTiles += result.cells == 0 ? 1 : 0;
+            for (auto segment : result.segments) {
+                segment.from = details::toTraceEdge(segment.from, i, j, tilesX * TILE_CELLS);
+                segment.to = details::toTraceEdge(segment.to, i, j, tilesX * TILE_CELLS);
+                segments.push_back(segment);
+            }
+        }
+
+        auto polylines = details::joinSegments(segments);
+        stats.segments = static_cast<std::uint32_t>(segments.size());
+        stats.polylines = static_cast<std::uint32_t>(polylines.size());
+        return polylines;
+    }
+}
\ No newline at end of file
@@ -109,6 +109,90 @@ namespace kubvc::math {
                 return result;
             }
         }
+
+        // Derivatives of real functions, they are used by dual number calculation
+        namespace derivative {
+            static inline double sin(double x) {
+                return glm::cos(x);
+            }
+
+            static inline double cos(double x) {
+                return -glm::sin(x);
+            }
+
+            static inline double tg(double x) {
+                const auto c = glm::cos(x);
+                return 1.0 / (c * c);
+            }
+
+            static inline double ctg(double x) {
+                const auto s = glm::sin(x);
+                return -1.0 / (s * s);
+            }
+
+            static inline double th(double x) {
+                const auto t = real::th(x);
+                return 1.0 - t * t;
+            }
+
+            static inline double cth(double x) {
+                const auto s = real::sh(x);
+                return -1.0 / (s * s);
+            }
+
+            static inline double sch(double x) {
+                return -real::th(x) * real::sch(x);
+            }
+
+            static inline double csch(double x) {
+                return -real::cth(x) * real::csch(x);
+            }
+
+            static inline double arccos(double x) {
+                return -1.0 / glm::sqrt(1.0 - x * x);
+            }
+
+            static inline double arcsin(double x) {
+                return 1.0 / glm::sqrt(1.0 - x * x);
+            }
+
+            static inline double arctg(double x) {
+                return 1.0 / (1.0 + x * x);
+            }
+
+            static inline double arcctg(double x) {
+                return -1.0 / (1.0 + x * x);
+            }
+
+            static inline double abs(double x) {
+                return x > 0.0 ? 1.0 : (x < 0.0 ? -1.0 : 0.0);
+            }
+
+            static inline double sqrt(double x) {
+                return 0.5 / glm::sqrt(x);
+            }
+
+            static inline double norm(double x) {
+                return 2.0 * x;
+            }
+
+            static inline double ln(double x) {
+                return 1.0 / x;
+            }
+
+            static inline double log10(double x) {
+                return 1.0 / (x * std::numbers::ln10_v<double>);
+            }
+
+            static inline double log2(double x) {
+                return 1.0 / (x * std::numbers::ln2_v<double>);
+            }
+
+            // Step functions like round and arg
+            static inline double zero([[maybe_unused]] double x) {
+                return 0.0;
+            }
+        }
     }
     
     namespace containers {
@@ -159,6 +243,41 @@ namespace kubvc::math {
                 { "rnd", functions::real::rnd }      
         }; 
 
+        // Derivatives of functions from list above, functions without derivative like fact and rnd are not here 
+        static constexpr std::initializer_list<std::pair<std::string_view, RealFunctionHandler>> DerivativeFunctions = {         
+                { "sin", functions::derivative::sin },
+                { "cos", functions::derivative::cos },
+                { "tg",  functions::derivative::tg },
+                { "ctg", functions::derivative::ctg },
+
+                { "sh", functions::real::ch },
+                { "ch", functions::real::sh },
+                { "th", functions::derivative::th },
+                { "cth", functions::derivative::cth },
+                { "sch", functions::derivative::sch },
+                { "csch", functions::derivative::csch },
+
+                { "arccos", functions::derivative::arccos },
+                { "arcsin", functions::derivative::arcsin },
+                { "arctg",  functions::derivative::arctg },
+                { "arcctg", functions::derivative::arcctg },
+
+                { "abs",   functions::derivative::abs },
+                { "exp",   glm::exp },
+                { "sqrt",  functions::derivative::sqrt },
+                { "norm",  functions::derivative::norm },
+                { "arg",   functions::derivative::zero },
+
+                { "ln",    functions::derivative::ln },
+                { "log10", functions::derivative::log10 },
+                { "log2",  functions::derivative::log2 },
+
+                { "round", functions::derivative::zero }
+        }; 
+
+        // Functions which can give different values for same argument, so their calls are never merged 
+        static constexpr std::initializer_list<std::string_view> NonDeterministicFunctions = { "rnd" };
+
         using ComplexFunctionHandler = utility::FunctionHandler<std::complex<double>(const std::complex<double>&)>;
 
         static constexpr std::initializer_list<std::pair<std::string_view, ComplexFunctionHandler>> ComplexFunctions = {         
@@ -1,5 +1,7 @@
 #pragma once 
 #include "alg_helpers.h"
+#include "dual.h"
+#include "interval.h"
 
 namespace kubvc::algorithm {
     enum class Operators {
@@ -32,4 +34,122 @@ namespace kubvc::algorithm {
         }
         return Operators::Unknown;
     } 
+
+    // Calculate binary operator in real mode
+    [[nodiscard]] static inline double calculateOperator(Operators type, double left, double right) {
+        switch (type) {
+            case Operators::Equal:
+                return right;
+            case Operators::Plus:
+                return left + right;
+            case Operators::Minus:
+                return left - right;
+            case Operators::Multiplication:
+                return left * right;
+            case Operators::Division: {
+                // If we are too close to zero we are set result as NaN
+                if (glm::abs(right) < std::numeric_limits<double>::min()) {  
+                    return std::numeric_limits<double>::quiet_NaN();
+                }
+                
+                return left / right;
+            }
+            case Operators::Module:
+                return glm::mod(left, right);
+            case Operators::Power:
+                return glm::pow(left, right);
+            default:
+                break;
+        }
+
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // Calculate binary operator with derivative, value is same as in real mode
+    [[nodiscard]] static inline math::Dual calculateDualOperator(Operators type, const math::Dual& left, const math::Dual& right) {
+        const auto value = calculateOperator(type, left.value, right.value);
+        switch (type) {
+            case Operators::Equal:
+                return right;
+            case Operators::Plus:
+                return left + right;
+            case Operators::Minus:
+                return left - right;
+            case Operators::Multiplication:
+                return left * right;
+            case Operators::Division:
+                return { value, (left.derivative * right.value - left.value * right.derivative) / (right.value * right.value) };
+            case Operators::Module:
+                return { value, left.derivative - glm::floor(left.value / right.value) * right.derivative };
+            case Operators::Power: {
+                // Most of powers have constant exponent, so we are avoid log of negative base here 
+                if (right.derivative == 0.0) {
+                    const auto derivative = left.derivative == 0.0 ? 0.0 : 
+                        right.value * glm::pow(left.value, right.value - 1.0) * left.derivative;
+                    return { value, derivative };
+                }
+
+                return { value, value * (right.derivative * glm::log(left.value) + right.value * left.derivative / left.value) };
+            }
+            default:
+                break;
+        }
+
+        return { value, std::numeric_limits<double>::quiet_NaN() };
+    }
+
+    // Calculate binary operator over intervals, result contains all values of real mode operator
+    [[nodiscard]] static inline math::Interval calculateIntervalOperator(Operators type, const math::Interval& left, const math::Interval& right) {
+        switch (type) {
+            case Operators::Equal:
+                return right;
+            case Operators::Plus:
+                return left + right;
+            case Operators::Minus:
+                return left - right;
+            case Operators::Multiplication:
+                return left * right;
+            case Operators::Division:
+                return left / right;
+            case Operators::Module:
+                return math::interval::mod(left, right);
+            case Operators::Power:
+                return math::interval::pow(left, right);
+            default:
+                break;
+        }
+
+        return math::Interval::empty();
+    }
+
+    // Calculate binary operator in complex mode
+    [[nodiscard]] static inline std::complex<double> calculateComplexOperator(Operators type, 
+        const std::complex<double>& left, const std::complex<double>& right) {
+        switch (type) {
+            case Operators::Equal:
+                return right;
+            case Operators::Plus:
+                return left + right;
+            case Operators::Minus:
+                return left - right;
+            case Operators::Multiplication:
+                return left * right;
+            case Operators::Division: {
+                // If we are too close to zero we are set result as NaN
+                if (std::abs(right) < std::numeric_limits<double>::min()) {  
+                    return { std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN() }; 
+                }
+                
+                return left / right;
+            }
+            case Operators::Module:
+                return { 0.0, 0.0 }; // TODO: 
+            case Operators::Power:
+                return std::pow(left, right);
+            default:
+                break;
+        }
+
+        return { 0.0, 0.0 };
+    }
 }
\ No newline at end of file
@@ -0,0 +1,431 @@
+#pragma once
+#include "dual.h"
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string_view>
+
+namespace kubvc::math::solvers {
+    enum class RootSolverTypes : std::uint8_t {
+        Newton,
+        Halley,
+        Brent,
+        ITP
+    };
+
+    static constexpr std::array<std::string_view, 4> RootSolverNames = { "Newton", "Halley", "Brent", "ITP" };
+
+    // Residual of curve along solved variable, each call is one calculation of program
+    struct Residual {
+        std::function<double(double)> value;
+        // Value with first derivative
+        std::function<Dual(double)> dual;
+        // First derivative with second one, it's empty if expression doesn't have symbolic derivative
+        std::function<Dual(double)> curvature;
+    };
+
+    struct RootSolverParams {
+        double min = 0.0;
+        double max = 1.0;
+        // Start point of open methods and center of bracket search
+        double guess = 0.5;
+        // Size of one pixel in units of solved variable, all tolerances are scaled by it
+        double pixelSize = 1e-3;
+        // Search root only near guess, it's used for warm start from previous root
+        bool isLocal = false;
+    };
+
+    struct RootSolverResult {
+        double root = std::numeric_limits<double>::quiet_NaN();
+        std::uint32_t iterations = 0;
+        std::uint32_t evaluations = 0;
+        // Open method is failed and root is found by bracketing method
+        bool isFallback = false;
+    };
+
+    struct IRootSolver {
+        IRootSolver() = default;
+        virtual ~IRootSolver() = default;
+
+        // Find root of residual in [min, max], root is NaN if it's not found
+        [[nodiscard]] virtual RootSolverResult solve(const Residual& f, const RootSolverParams& params) const = 0;
+        [[nodiscard]] virtual RootSolverTypes getType() const = 0;
+    };
+
+    // Root is found if its error is less than this part of pixel
+    static constexpr auto PIXEL_TOLERANCE = 1e-3;
+    // Step of open method is small near pole too, because f / f' goes to zero there, 
+    // so root is accepted only if its residual is less than this count of pixels
+    static constexpr auto RESIDUAL_PIXELS = 1.0;
+    static constexpr std::uint32_t MAX_ITERATIONS = 16;
+    // Max iterations of bracketing methods, bracket is halved at least once per two iterations, so it's enough for any range
+    static constexpr std::uint32_t MAX_BRACKET_ITERATIONS = 128;
+    // Distance in pixels where local search is looking for sign change
+    static constexpr auto LOCAL_SEARCH_PIXELS = 16.0;
+    // Relative step for central difference, it's used only when some function doesn't have derivative
+    static constexpr auto DERIVATIVE_STEP = 1e-6;
+
+    struct Bracket {
+        double a;
+        double fa;
+        double b;
+        double fb;
+    };
+
+    [[nodiscard]] static inline bool hasSignChange(double fa, double fb) {
+        return (fa < 0.0 && fb > 0.0) || (fa > 0.0 && fb < 0.0);
+    }
+
+    // Search sign change around guess, step grows twice each time until it covers search range.
+    // Nearest sign change is taken, so curve is not jumping to another branch between samples
+    [[nodiscard]] static inline std::optional<Bracket> findBracket(const Residual& f, const RootSolverParams& params, RootSolverResult& result) {
+        const auto radius = params.isLocal ? LOCAL_SEARCH_PIXELS * params.pixelSize : params.max - params.min;
+        const auto min = std::max(params.min, params.guess - radius);
+        const auto max = std::min(params.max, params.guess + radius);
+
+        auto left = params.guess;
+        auto fLeft = f.value(left);
+        auto right = left;
+        auto fRight = fLeft;
+        ++result.evaluations;
+        if (fLeft == 0.0) {
+            return Bracket { left, fLeft, right, fRight };
+        }
+
+        for (auto step = params.pixelSize; left > min || right < max; step *= 2.0) {
+            if (left > min) {
+                const auto next = std::max(min, params.guess - step);
+                const auto fNext = f.value(next);
+                ++result.evaluations;
+                if (hasSignChange(fNext, fLeft)) {
+                    return Bracket { next, fNext, left, fLeft };
+                }
+
+                left = next;
+                fLeft = fNext;
+            }
+
+            if (right < max) {
+                const auto next = std::min(max, params.guess + step);
+                const auto fNext = f.value(next);
+                ++result.evaluations;
+                if (hasSignChange(fRight, fNext)) {
+                    return Bracket { right, fRight, next, fNext };
+                }
+
+                right = next;
+                fRight = fNext;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    // Brent's method: inverse quadratic interpolation or secant step,
+    // bisection is used when they are too slow or step is outside of bracket
+    [[nodiscard]] static inline double solveBrent(const Residual& f, const Bracket& bracket, double tolerance, RootSolverResult& result) {
+        auto a = bracket.a;
+        auto b = bracket.b;
+        auto fa = bracket.fa;
+        auto fb = bracket.fb;
+        if (fa == 0.0) {
+            return a;
+        }
+
+        auto c = a;
+        auto fc = fa;
+        auto d = b - a;
+        auto e = d;
+        for (std::uint32_t i = 0; i < MAX_BRACKET_ITERATIONS; ++i) {
+            ++result.iterations;
+            // Keep root between b and c, and b is the best approximation
+            if (!hasSignChange(fb, fc)) {
+                c = a;
+                fc = fa;
+                d = b - a;
+                e = d;
+            }
+
+            if (std::abs(fc) < std::abs(fb)) {
+                a = b;
+                b = c;
+                c = a;
+                fa = fb;
+                fb = fc;
+                fc = fa;
+            }
+
+            const auto tol = 2.0 * std::numeric_limits<double>::epsilon() * std::abs(b) + 0.5 * tolerance;
+            const auto middle = 0.5 * (c - b);
+            if (std::abs(middle) <= tol || fb == 0.0) {
+                return b;
+            }
+
+            if (std::abs(e) >= tol && std::abs(fa) > std::abs(fb)) {
+                auto p = 0.0;
+                auto q = 0.0;
+                const auto s = fb / fa;
+                if (a == c) {
+                    // Secant
+                    p = 2.0 * middle * s;
+                    q = 1.0 - s;
+                } else {
+                    // Inverse quadratic interpolation
+                    const auto r = fb / fc;
+                    const auto t = fa / fc;
+                    p = s * (2.0 * middle * t * (t - r) - (b - a) * (r - 1.0));
+                    q = (t - 1.0) * (r - 1.0) * (s - 1.0);
+                }
+
+                if (p > 0.0) {
+                    q = -q;
+                } else {
+                    p = -p;
+                }
+
+                if (2.0 * p < std::min(3.0 * middle * q - std::abs(tol * q), std::abs(e * q))) {
+                    e = d;
+                    d = p / q;
+                } else {
+                    d = middle;
+                    e = d;
+                }
+            } else {
+                d = middle;
+                e = d;
+            }
+
+            a = b;
+            fa = fb;
+            b += std::abs(d) > tol ? d : (middle > 0.0 ? tol : -tol);
+            fb = f.value(b);
+            ++result.evaluations;
+            if (std::isnan(fb)) {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+        }
+
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    // ITP method: regula falsi point is truncated to the middle and projected to the range around it,
+    // so it's never slower than bisection, but it's superlinear for smooth functions
+    [[nodiscard]] static inline double solveITP(const Residual& f, const Bracket& bracket, double tolerance, RootSolverResult& result) {
+        // Parameters recommended by authors of method
+        constexpr auto K2 = 2.0;
+        constexpr auto N0 = 1.0;
+
+        auto a = bracket.a;
+        auto b = bracket.b;
+        auto fa = bracket.fa;
+        auto fb = bracket.fb;
+        if (fa == 0.0) {
+            return a;
+        }
+        if (fb == 0.0 || b - a <= 2.0 * tolerance) {
+            return (a + b) * 0.5;
+        }
+
+        const auto k1 = 0.2 / (b - a);
+        const auto maxSteps = std::ceil(std::log2((b - a) / (2.0 * tolerance))) + N0;
+        for (std::uint32_t i = 0; i < MAX_BRACKET_ITERATIONS && b - a > 2.0 * tolerance; ++i) {
+            ++result.iterations;
+            const auto middle = (a + b) * 0.5;
+            const auto radius = tolerance * std::exp2(maxSteps - i) - (b - a) * 0.5;
+            const auto delta = k1 * std::pow(b - a, K2);
+
+            // Interpolation
+            const auto regulaFalsi = (b * fa - a * fb) / (fa - fb);
+            const auto sigma = middle - regulaFalsi >= 0.0 ? 1.0 : -1.0;
+            // Truncation
+            const auto truncated = delta <= std::abs(middle - regulaFalsi) ? regulaFalsi + sigma * delta : middle;
+            // Projection
+            const auto x = std::abs(truncated - middle) <= radius ? truncated : middle - sigma * radius;
+
+            const auto fx = f.value(x);
+            ++result.evaluations;
+            if (std::isnan(fx)) {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+
+            if (fx == 0.0) {
+                return x;
+            }
+
+            if (hasSignChange(fa, fx)) {
+                b = x;
+                fb = fx;
+            } else {
+                a = x;
+                fa = fx;
+            }
+        }
+
+        return (a + b) * 0.5;
+    }
+
+    // Solve by bracketing method when open method is failed, local search doesn't use it
+    [[nodiscard]] static inline RootSolverResult solveFallback(const Residual& f, const RootSolverParams& params, RootSolverResult result) {
+        if (params.isLocal) {
+            result.root = std::numeric_limits<double>::quiet_NaN();
+            return result;
+        }
+
+        result.isFallback = true;
+        const auto bracket = findBracket(f, params, result);
+        result.root = bracket.has_value() ? solveBrent(f, bracket.value(), params.pixelSize * PIXEL_TOLERANCE, result) :
+            std::numeric_limits<double>::quiet_NaN();
+        return result;
+    }
+
+    // Derivative by central difference, it's used when some function doesn't have derivative
+    [[nodiscard]] static inline double calculateDerivative(const Residual& f, double x, RootSolverResult& result) {
+        const auto step = DERIVATIVE_STEP * std::max(1.0, std::abs(x));
+        result.evaluations += 2;
+        return (f.value(x + step) - f.value(x - step)) / (2.0 * step);
+    }
+
+    struct NewtonSolver : IRootSolver {
+        [[nodiscard]] virtual RootSolverTypes getType() const final { return RootSolverTypes::Newton; }
+
+        [[nodiscard]] virtual RootSolverResult solve(const Residual& f, const RootSolverParams& params) const final {
+            const auto tolerance = params.pixelSize * PIXEL_TOLERANCE;
+            RootSolverResult result { };
+            auto x = params.guess;
+            auto fx = f.dual(x);
+            ++result.evaluations;
+            for (std::uint32_t i = 0; i < MAX_ITERATIONS; ++i) {
+                ++result.iterations;
+                if (std::isnan(fx.value)) {
+                    return result;
+                }
+
+                auto derivative = fx.derivative;
+                if (std::isnan(derivative)) {
+                    derivative = calculateDerivative(f, x, result);
+                }
+
+                if (std::isnan(derivative) || derivative == 0.0) {
+                    return solveFallback(f, params, result);
+                }
+
+                const auto delta = fx.value / derivative;
+                x -= delta;
+                if (x < params.min || x > params.max) {
+                    return solveFallback(f, params, result);
+                }
+
+                fx = f.dual(x);
+                ++result.evaluations;
+                if (std::abs(delta) < tolerance && std::abs(fx.value) <= params.pixelSize * RESIDUAL_PIXELS) {
+                    result.root = x;
+                    return result;
+                }
+            }
+
+            return result;
+        }
+    };
+
+    // Newton method with second derivative, it has cubic convergence.
+    // It's same as Newton if expression doesn't have symbolic derivative
+    struct HalleySolver : IRootSolver {
+        [[nodiscard]] virtual RootSolverTypes getType() const final { return RootSolverTypes::Halley; }
+
+        [[nodiscard]] virtual RootSolverResult solve(const Residual& f, const RootSolverParams& params) const final {
+            if (!f.curvature) {
+                return NewtonSolver { }.solve(f, params);
+            }
+
+            const auto tolerance = params.pixelSize * PIXEL_TOLERANCE;
+            RootSolverResult result { };
+            auto x = params.guess;
+            auto value = f.value(x);
+            ++result.evaluations;
+            for (std::uint32_t i = 0; i < MAX_ITERATIONS; ++i) {
+                ++result.iterations;
+                if (std::isnan(value)) {
+                    return result;
+                }
+
+                const auto curvature = f.curvature(x);
+                ++result.evaluations;
+
+                auto derivative = curvature.value;
+                if (std::isnan(derivative)) {
+                    derivative = calculateDerivative(f, x, result);
+                }
+
+                if (std::isnan(derivative) || derivative == 0.0) {
+                    return solveFallback(f, params, result);
+                }
+
+                // Take Newton step if second derivative is unknown
+                const auto denominator = 2.0 * derivative * derivative - value * curvature.derivative;
+                const auto delta = std::isnan(denominator) || denominator == 0.0 ?
+                    value / derivative : 2.0 * value * derivative / denominator;
+                x -= delta;
+                if (x < params.min || x > params.max) {
+                    return solveFallback(f, params, result);
+                }
+
+                value = f.value(x);
+                ++result.evaluations;
+                if (std::abs(delta) < tolerance && std::abs(value) <= params.pixelSize * RESIDUAL_PIXELS) {
+                    result.root = x;
+                    return result;
+                }
+            }
+
+            return result;
+        }
+    };
+
+    struct BrentSolver : IRootSolver {
+        [[nodiscard]] virtual RootSolverTypes getType() const final { return RootSolverTypes::Brent; }
+
+        [[nodiscard]] virtual RootSolverResult solve(const Residual& f, const RootSolverParams& params) const final {
+            RootSolverResult result { };
+            const auto bracket = findBracket(f, params, result);
+            if (bracket.has_value()) {
+                result.root = solveBrent(f, bracket.value(), params.pixelSize * PIXEL_TOLERANCE, result);
+            }
+            return result;
+        }
+    };
+
+    struct ITPSolver : IRootSolver {
+        [[nodiscard]] virtual RootSolverTypes getType() const final { return RootSolverTypes::ITP; }
+
+        [[nodiscard]] virtual RootSolverResult solve(const Residual& f, const RootSolverParams& params) const final {
+            RootSolverResult result { };
+            const auto bracket = findBracket(f, params, result);
+            if (bracket.has_value()) {
+                result.root = solveITP(f, bracket.value(), params.pixelSize * PIXEL_TOLERANCE, result);
+            }
+            return result;
+        }
+    };
+
+    // Solvers don't have state, so they are shared by all expressions
+    [[nodiscard]] inline const IRootSolver& getRootSolver(RootSolverTypes type) {
+        static const NewtonSolver newton;
+        static const HalleySolver halley;
+        static const BrentSolver brent;
+        static const ITPSolver itp;
+        switch (type) {
+            case RootSolverTypes::Halley:
+                return halley;
+            case RootSolverTypes::Brent:
+                return brent;
+            case RootSolverTypes::ITP:
+                return itp;
+            default:
+                return newton;
+        }
+    }
+}
@@ -0,0 +1,157 @@
+#include "simd_kernels.h"
+#include "operators.h"
+#include "container.h"
+#include "logger.h"
+
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #define KUB_SIMD_X86_64
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+namespace kubvc::algorithm::simd {
+    namespace {
+        template<Operators Type>
+        void operatorKernel(double* left, const double* right, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+                left[i] = calculateOperator(Type, left[i], right[i]);
+            }
+        }
+
+        void negateKernel(double* values, std::size_t count) {
+            for (std::size_t i = 0; i < count; ++i) {
+                values[i] = -values[i];
+            }
+        }
+
+        static constexpr std::initializer_list<std::pair<std::string_view, UnaryKernel KernelTable::*>> FunctionKernels = {
+            { "sin", &KernelTable::sin },
+            { "cos", &KernelTable::cos },
+            { "tg", &KernelTable::tan },
+            { "exp", &KernelTable::exp },
+            { "ln", &KernelTable::log },
+            { "sqrt", &KernelTable::sqrt },
+            { "abs", &KernelTable::abs },
+        };
+
+#ifdef KUB_SIMD_X86_64
+        struct CpuidRegisters {
+            std::uint32_t eax = 0;
+            std::uint32_t ebx = 0;
+            std::uint32_t ecx = 0;
+            std::uint32_t edx = 0;
+        };
+
+        CpuidRegisters cpuid(std::uint32_t leaf, std::uint32_t subleaf) {
+            CpuidRegisters registers;
+#ifdef _MSC_VER
+            int values[4] = { };
+            __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+            registers.eax = static_cast<std::uint32_t>(values[0]);
+            registers.ebx = static_cast<std::uint32_t>(values[1]);
+            registers.ecx = static_cast<std::uint32_t>(values[2]);
+            registers.edx = static_cast<std::uint32_t>(values[3]);
+#else
+            __cpuid_count(leaf, subleaf, registers.eax, registers.ebx, registers.ecx, registers.edx);
+#endif
+            return registers;
+        }
+
+        // Get extended control register, it's tells which register states are saved by os
+        std::uint64_t xgetbv(std::uint32_t index) {
+#ifdef _MSC_VER
+            return _xgetbv(index);
+#else
+            std::uint32_t eax = 0;
+            std::uint32_t edx = 0;
+            __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+            return (static_cast<std::uint64_t>(edx) << 32) | eax;
+#endif
+        }
+#endif
+    }
+
+    const KernelTable& getScalarKernelTable() {
+        static const KernelTable table = [] {
+            KernelTable scalar;
+            scalar.instructionSet = InstructionSet::Scalar;
+            scalar.add = &operatorKernel<Operators::Plus>;
+            scalar.subtract = &operatorKernel<Operators::Minus>;
+            scalar.multiply = &operatorKernel<Operators::Multiplication>;
+            scalar.divide = &operatorKernel<Operators::Division>;
+            scalar.module = &operatorKernel<Operators::Module>;
+            scalar.power = &operatorKernel<Operators::Power>;
+            scalar.negate = &negateKernel;
+            // Functions are left empty, program is using function handlers for them
+            return scalar;
+        }();
+
+        return table;
+    }
+
+    InstructionSet detectInstructionSet() {
+#ifdef KUB_SIMD_X86_64
+        // SSE2 is part of x86-64
+        auto instructionSet = InstructionSet::SSE2;
+
+        const auto maxLeaf = cpuid(0, 0).eax;
+        const auto features = cpuid(1, 0);
+        const bool hasOsxsave = (features.ecx & (1u << 27)) != 0;
+        const bool hasAvx = (features.ecx & (1u << 28)) != 0;
+        if (maxLeaf < 7 || !hasOsxsave || !hasAvx)
+            return instructionSet;
+
+        // Check that os is saving ymm and zmm registers
+        const auto xcr0 = xgetbv(0);
+        const bool hasYmmState = (xcr0 & 0x6) == 0x6;
+        const bool hasZmmState = (xcr0 & 0xE6) == 0xE6;
+
+        const auto extendedFeatures = cpuid(7, 0);
+        const bool hasAvx2 = (extendedFeatures.ebx & (1u << 5)) != 0;
+        const bool hasAvx512f = (extendedFeatures.ebx & (1u << 16)) != 0;
+
+        if (hasYmmState && hasAvx2)
+            instructionSet = InstructionSet::AVX2;
+
+        if (hasZmmState && hasAvx512f)
+            instructionSet = InstructionSet::AVX512;
+
+        return instructionSet;
+#else
+        return InstructionSet::Scalar;
+#endif
+    }
+
+    const KernelTable& getKernelTable() {
+        static const KernelTable& table = []() -> const KernelTable& {
+            const auto instructionSet = detectInstructionSet();
+            KUB_DEBUG("Selected {} kernels", getInstructionSetName(instructionSet));
+
+            switch (instructionSet) {
+                case InstructionSet::AVX512:
+                    return getAvx512KernelTable();
+                case InstructionSet::AVX2:
+                    return getAvx2KernelTable();
+                case InstructionSet::SSE2:
+                    return getSse2KernelTable();
+                default:
+                    return getScalarKernelTable();
+            }
+        }();
+
+        return table;
+    }
+
+    UnaryKernel getFunctionKernel(std::string_view name) {
+        const auto member = utility::container::get(FunctionKernels, name);
+        if (!member.has_value())
+            return nullptr;
+
+        return getKernelTable().*(member.value());
+    }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <string_view>
+
+namespace kubvc::algorithm::simd {
+    enum class InstructionSet {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    // Kernels are working in place: left[i] = op(left[i], right[i]) and values[i] = f(values[i])
+    using BinaryKernel = void(*)(double* left, const double* right, std::size_t count);
+    using UnaryKernel = void(*)(double* values, std::size_t count);
+
+    struct KernelTable {
+        InstructionSet instructionSet = InstructionSet::Scalar;
+
+        BinaryKernel add = nullptr;
+        BinaryKernel subtract = nullptr;
+        BinaryKernel multiply = nullptr;
+        // Result is NaN when divisor is too close to zero
+        BinaryKernel divide = nullptr;
+        BinaryKernel module = nullptr;
+        BinaryKernel power = nullptr;
+
+        UnaryKernel negate = nullptr;
+        UnaryKernel sin = nullptr;
+        UnaryKernel cos = nullptr;
+        UnaryKernel tan = nullptr;
+        UnaryKernel exp = nullptr;
+        UnaryKernel log = nullptr;
+        UnaryKernel sqrt = nullptr;
+        UnaryKernel abs = nullptr;
+    };
+
+    // Get kernel table for best instruction set which is supported by current cpu, it's selected once on first call
+    [[nodiscard]] const KernelTable& getKernelTable();
+
+    // Get vectorized kernel for function from math::containers::Functions, nullptr if function doesn't have it
+    [[nodiscard]] UnaryKernel getFunctionKernel(std::string_view name);
+
+    [[nodiscard]] InstructionSet detectInstructionSet();
+
+    [[nodiscard]] constexpr std::string_view getInstructionSetName(InstructionSet instructionSet) {
+        switch (instructionSet) {
+            case InstructionSet::Scalar:
+                return "Scalar";
+            case InstructionSet::SSE2:
+                return "SSE2";
+            case InstructionSet::AVX2:
+                return "AVX2";
+            case InstructionSet::AVX512:
+                return "AVX-512";
+        }
+        return "Unknown";
+    }
+
+    // Tables for each instruction set, every one is compiled in own translation unit with own flags
+    const KernelTable& getScalarKernelTable();
+    const KernelTable& getSse2KernelTable();
+    const KernelTable& getAvx2KernelTable();
+    const KernelTable& getAvx512KernelTable();
+}
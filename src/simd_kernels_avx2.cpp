@@ -0,0 +1,75 @@
+#include "simd_kernels.h"
+
+// This file is compiled with AVX2 flags, see CMakeLists.txt
+#if defined(_M_X64) || defined(__x86_64__)
+#include "simd_kernels_impl.h"
+#include <immintrin.h>
+
+namespace kubvc::algorithm::simd {
+    namespace {
+        struct Avx2 {
+            using Vector = __m256d;
+            using Mask = __m256d;
+            static constexpr std::size_t WIDTH = 4;
+
+            static Vector load(const double* source) { return _mm256_loadu_pd(source); }
+            static void store(double* destination, Vector value) { _mm256_storeu_pd(destination, value); }
+            static Vector broadcast(double value) { return _mm256_set1_pd(value); }
+
+            static Vector add(Vector left, Vector right) { return _mm256_add_pd(left, right); }
+            static Vector sub(Vector left, Vector right) { return _mm256_sub_pd(left, right); }
+            static Vector mul(Vector left, Vector right) { return _mm256_mul_pd(left, right); }
+            static Vector div(Vector left, Vector right) { return _mm256_div_pd(left, right); }
+            static Vector sqrt(Vector value) { return _mm256_sqrt_pd(value); }
+            static Vector abs(Vector value) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), value); }
+            static Vector negate(Vector value) { return _mm256_xor_pd(value, _mm256_set1_pd(-0.0)); }
+            static Vector floor(Vector value) { return _mm256_floor_pd(value); }
+
+            static Mask less(Vector left, Vector right) { return _mm256_cmp_pd(left, right, _CMP_LT_OQ); }
+            static Mask lessEqual(Vector left, Vector right) { return _mm256_cmp_pd(left, right, _CMP_LE_OQ); }
+            static Mask greater(Vector left, Vector right) { return _mm256_cmp_pd(left, right, _CMP_GT_OQ); }
+            static Mask greaterEqual(Vector left, Vector right) { return _mm256_cmp_pd(left, right, _CMP_GE_OQ); }
+            static Mask equal(Vector left, Vector right) { return _mm256_cmp_pd(left, right, _CMP_EQ_OQ); }
+
+            static Mask maskAnd(Mask left, Mask right) { return _mm256_and_pd(left, right); }
+            static Mask maskOr(Mask left, Mask right) { return _mm256_or_pd(left, right); }
+            static Mask maskXor(Mask left, Mask right) { return _mm256_xor_pd(left, right); }
+            static Mask maskNot(Mask mask) { return _mm256_xor_pd(mask, _mm256_castsi256_pd(_mm256_set1_epi64x(-1))); }
+            static unsigned maskBits(Mask mask) { return static_cast<unsigned>(_mm256_movemask_pd(mask)); }
+
+            static Vector select(Mask mask, Vector ifTrue, Vector ifFalse) { return _mm256_blendv_pd(ifFalse, ifTrue, mask); }
+
+            // 2^n for integral n in normal exponent range
+            static Vector pow2(Vector n) {
+                const auto magic = _mm256_set1_pd(0x1.8p52);
+                const auto integer = _mm256_sub_epi64(_mm256_castpd_si256(_mm256_add_pd(n, magic)), _mm256_castpd_si256(magic));
+                return _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_add_epi64(integer, _mm256_set1_epi64x(1023)), 52));
+            }
+
+            // Exponent and mantissa like in frexp, value must be positive normal number
+            static Vector exponent(Vector value) {
+                const auto magic = _mm256_set1_pd(0x1p52);
+                const auto biased = _mm256_srli_epi64(_mm256_castpd_si256(value), 52);
+                const auto exponent = _mm256_sub_pd(_mm256_or_pd(_mm256_castsi256_pd(biased), magic), magic);
+                return _mm256_sub_pd(exponent, _mm256_set1_pd(1022.0));
+            }
+
+            static Vector mantissa(Vector value) {
+                const auto mantissaBits = _mm256_castsi256_pd(_mm256_set1_epi64x(0x000FFFFFFFFFFFFF));
+                return _mm256_or_pd(_mm256_and_pd(value, mantissaBits), _mm256_set1_pd(0.5));
+            }
+        };
+    }
+
+    const KernelTable& getAvx2KernelTable() {
+        static const KernelTable table = impl::makeKernelTable<Avx2>(InstructionSet::AVX2);
+        return table;
+    }
+}
+#else
+namespace kubvc::algorithm::simd {
+    const KernelTable& getAvx2KernelTable() {
+        return getScalarKernelTable();
+    }
+}
+#endif
@@ -0,0 +1,79 @@
+#include "simd_kernels.h"
+
+// This file is compiled with AVX-512 flags, see CMakeLists.txt
+// Only AVX-512F instructions are used, so bitwise operations are done on integer registers
+#if defined(_M_X64) || defined(__x86_64__)
+#include "simd_kernels_impl.h"
+#include <immintrin.h>
+
+namespace kubvc::algorithm::simd {
+    namespace {
+        struct Avx512 {
+            using Vector = __m512d;
+            using Mask = __mmask8;
+            static constexpr std::size_t WIDTH = 8;
+
+            static Vector load(const double* source) { return _mm512_loadu_pd(source); }
+            static void store(double* destination, Vector value) { _mm512_storeu_pd(destination, value); }
+            static Vector broadcast(double value) { return _mm512_set1_pd(value); }
+
+            static Vector add(Vector left, Vector right) { return _mm512_add_pd(left, right); }
+            static Vector sub(Vector left, Vector right) { return _mm512_sub_pd(left, right); }
+            static Vector mul(Vector left, Vector right) { return _mm512_mul_pd(left, right); }
+            static Vector div(Vector left, Vector right) { return _mm512_div_pd(left, right); }
+            static Vector sqrt(Vector value) { return _mm512_sqrt_pd(value); }
+            static Vector abs(Vector value) { return _mm512_abs_pd(value); }
+            static Vector floor(Vector value) { return _mm512_roundscale_pd(value, _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC); }
+
+            static Vector negate(Vector value) {
+                return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(value), _mm512_set1_epi64(INT64_MIN)));
+            }
+
+            static Mask less(Vector left, Vector right) { return _mm512_cmp_pd_mask(left, right, _CMP_LT_OQ); }
+            static Mask lessEqual(Vector left, Vector right) { return _mm512_cmp_pd_mask(left, right, _CMP_LE_OQ); }
+            static Mask greater(Vector left, Vector right) { return _mm512_cmp_pd_mask(left, right, _CMP_GT_OQ); }
+            static Mask greaterEqual(Vector left, Vector right) { return _mm512_cmp_pd_mask(left, right, _CMP_GE_OQ); }
+            static Mask equal(Vector left, Vector right) { return _mm512_cmp_pd_mask(left, right, _CMP_EQ_OQ); }
+
+            static Mask maskAnd(Mask left, Mask right) { return static_cast<Mask>(left & right); }
+            static Mask maskOr(Mask left, Mask right) { return static_cast<Mask>(left | right); }
+            static Mask maskXor(Mask left, Mask right) { return static_cast<Mask>(left ^ right); }
+            static Mask maskNot(Mask mask) { return static_cast<Mask>(~mask); }
+            static unsigned maskBits(Mask mask) { return mask; }
+
+            static Vector select(Mask mask, Vector ifTrue, Vector ifFalse) { return _mm512_mask_blend_pd(mask, ifFalse, ifTrue); }
+
+            // 2^n for integral n in normal exponent range
+            static Vector pow2(Vector n) {
+                const auto magic = _mm512_set1_pd(0x1.8p52);
+                const auto integer = _mm512_sub_epi64(_mm512_castpd_si512(_mm512_add_pd(n, magic)), _mm512_castpd_si512(magic));
+                return _mm512_castsi512_pd(_mm512_slli_epi64(_mm512_add_epi64(integer, _mm512_set1_epi64(1023)), 52));
+            }
+
+            // Exponent and mantissa like in frexp, value must be positive normal number
+            static Vector exponent(Vector value) {
+                const auto magic = _mm512_set1_pd(0x1p52);
+                const auto biased = _mm512_srli_epi64(_mm512_castpd_si512(value), 52);
+                const auto exponent = _mm512_sub_pd(_mm512_castsi512_pd(_mm512_or_si512(biased, _mm512_castpd_si512(magic))), magic);
+                return _mm512_sub_pd(exponent, _mm512_set1_pd(1022.0));
+            }
+
+            static Vector mantissa(Vector value) {
+                const auto mantissaBits = _mm512_and_si512(_mm512_castpd_si512(value), _mm512_set1_epi64(0x000FFFFFFFFFFFFF));
+                return _mm512_castsi512_pd(_mm512_or_si512(mantissaBits, _mm512_castpd_si512(_mm512_set1_pd(0.5))));
+            }
+        };
+    }
+
+    const KernelTable& getAvx512KernelTable() {
+        static const KernelTable table = impl::makeKernelTable<Avx512>(InstructionSet::AVX512);
+        return table;
+    }
+}
+#else
+namespace kubvc::algorithm::simd {
+    const KernelTable& getAvx512KernelTable() {
+        return getScalarKernelTable();
+    }
+}
+#endif
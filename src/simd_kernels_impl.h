@@ -0,0 +1,395 @@
+#pragma once
+// Generic vector kernels, included only by simd_kernels_*.cpp files.
+// Every instruction set provides a traits type with static load/store/arithmetic/mask functions
+// and the traits type must have internal linkage, so instantiations are never shared between
+// translation units that are compiled with different instruction set flags.
+#include "simd_kernels.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace kubvc::algorithm::simd::impl {
+    static constexpr double MIN_DIVISOR = std::numeric_limits<double>::min();
+    static constexpr double MAX_DOUBLE = std::numeric_limits<double>::max();
+    static constexpr double QUIET_NAN = std::numeric_limits<double>::quiet_NaN();
+
+    // Coefficients are taken from Cephes Math Library
+    static constexpr double LOG2E = 1.4426950408889634073599;
+    static constexpr double EXP_C1 = 6.93145751953125E-1;
+    static constexpr double EXP_C2 = 1.42860682030941723212E-6;
+    // Outside of this range result is overflowed, underflowed or denormal
+    static constexpr double EXP_MIN_ARGUMENT = -708.0;
+    static constexpr double EXP_MAX_ARGUMENT = 709.0;
+    static constexpr double EXP_P[] = {
+        1.26177193074810590878E-4,
+        3.02994407707441961300E-2,
+        9.99999999999999999910E-1
+    };
+    static constexpr double EXP_Q[] = {
+        3.00198505138664455042E-6,
+        2.52448340349684104192E-3,
+        2.27265548208155028766E-1,
+        2.00000000000000000009E0
+    };
+
+    static constexpr double SQRTH = 0.70710678118654752440;
+    // Coefficients are taken from fdlibm, log(1 + f) = f - f^2 / 2 + s * (f^2 / 2 + R(s^2)), where s = f / (2 + f)
+    static constexpr double LN2_HI = 6.93147180369123816490e-01;
+    static constexpr double LN2_LO = 1.90821492927058770002e-10;
+    static constexpr double LOG_COEFFICIENTS[] = {
+        1.479819860511658591e-01,
+        1.531383769920937332e-01,
+        1.818357216161805012e-01,
+        2.222219843214978396e-01,
+        2.857142874366239149e-01,
+        3.999999999940941908e-01,
+        6.666666666666735130e-01,
+    };
+
+    static constexpr double FOUR_OVER_PI = 1.27323954473516268615;
+    // Argument reduction is exact only for limited range
+    static constexpr double TRIGONOMETRIC_MAX_ARGUMENT = 1.0e8;
+    static constexpr double SIN_DP1 = 7.85398125648498535156E-1;
+    static constexpr double SIN_DP2 = 3.77489470793079817668E-8;
+    static constexpr double SIN_DP3 = 2.69515142907905952645E-15;
+    static constexpr double SIN_COEFFICIENTS[] = {
+        1.58962301576546568060E-10,
+        -2.50507477628578072866E-8,
+        2.75573136213857245213E-6,
+        -1.98412698295895385996E-4,
+        8.33333333332211858878E-3,
+        -1.66666666666666307295E-1,
+    };
+    static constexpr double COS_COEFFICIENTS[] = {
+        -1.13585365213876817300E-11,
+        2.08757008419747316778E-9,
+        -2.75573141792967388112E-7,
+        2.48015872888517045348E-5,
+        -1.38888888888730564116E-3,
+        4.16666666666665929218E-2,
+    };
+
+    static constexpr double TAN_DP1 = 7.853981554508209228515625E-1;
+    static constexpr double TAN_DP2 = 7.94662735614792836714E-9;
+    static constexpr double TAN_DP3 = 3.06161699786838294307E-17;
+    static constexpr double TAN_P[] = {
+        -1.30936939181383777646E4,
+        1.15351664838587416140E6,
+        -1.79565251976484877988E7,
+    };
+    static constexpr double TAN_Q[] = {
+        1.36812963470692954678E4,
+        -1.32089234440210967447E6,
+        2.50083801823357915839E7,
+        -5.38695755929454629881E7,
+    };
+
+    template<typename V, std::size_t N>
+    inline typename V::Vector polevl(typename V::Vector x, const double (&coefficients)[N]) {
+        auto result = V::broadcast(coefficients[0]);
+        for (std::size_t i = 1; i < N; ++i) {
+            result = V::add(V::mul(result, x), V::broadcast(coefficients[i]));
+        }
+        return result;
+    }
+
+    // Same as polevl, but leading coefficient is 1.0 and it's omitted
+    template<typename V, std::size_t N>
+    inline typename V::Vector p1evl(typename V::Vector x, const double (&coefficients)[N]) {
+        auto result = V::add(x, V::broadcast(coefficients[0]));
+        for (std::size_t i = 1; i < N; ++i) {
+            result = V::add(V::mul(result, x), V::broadcast(coefficients[i]));
+        }
+        return result;
+    }
+
+    template<typename V, typename VectorOperation, typename ScalarOperation>
+    inline void applyBinary(double* left, const double* right, std::size_t count,
+        VectorOperation&& vectorOperation, ScalarOperation&& scalarOperation) {
+        std::size_t i = 0;
+        for (; i + V::WIDTH <= count; i += V::WIDTH) {
+            V::store(left + i, vectorOperation(V::load(left + i), V::load(right + i)));
+        }
+
+        for (; i < count; ++i) {
+            left[i] = scalarOperation(left[i], right[i]);
+        }
+    }
+
+    // Vector operation marks lanes which it can't calculate precisely in fallback mask,
+    // then these lanes are recalculated by scalar operation
+    template<typename V, typename VectorOperation, typename ScalarOperation>
+    inline void applyUnaryWithFallback(double* values, std::size_t count,
+        VectorOperation&& vectorOperation, ScalarOperation&& scalarOperation) {
+        std::size_t i = 0;
+        for (; i + V::WIDTH <= count; i += V::WIDTH) {
+            const auto input = V::load(values + i);
+            typename V::Mask fallback;
+            V::store(values + i, vectorOperation(input, fallback));
+
+            auto lanes = V::maskBits(fallback);
+            if (lanes != 0) {
+                double inputLanes[V::WIDTH];
+                V::store(inputLanes, input);
+                for (std::size_t lane = 0; lanes != 0; ++lane, lanes >>= 1) {
+                    if (lanes & 1) {
+                        values[i + lane] = scalarOperation(inputLanes[lane]);
+                    }
+                }
+            }
+        }
+
+        for (; i < count; ++i) {
+            values[i] = scalarOperation(values[i]);
+        }
+    }
+
+    template<typename V, typename VectorOperation, typename ScalarOperation>
+    inline void applyBinaryWithFallback(double* left, const double* right, std::size_t count,
+        VectorOperation&& vectorOperation, ScalarOperation&& scalarOperation) {
+        std::size_t i = 0;
+        for (; i + V::WIDTH <= count; i += V::WIDTH) {
+            const auto leftInput = V::load(left + i);
+            const auto rightInput = V::load(right + i);
+            typename V::Mask fallback;
+            V::store(left + i, vectorOperation(leftInput, rightInput, fallback));
+
+            auto lanes = V::maskBits(fallback);
+            if (lanes != 0) {
+                double leftLanes[V::WIDTH];
+                V::store(leftLanes, leftInput);
+                for (std::size_t lane = 0; lanes != 0; ++lane, lanes >>= 1) {
+                    if (lanes & 1) {
+                        left[i + lane] = scalarOperation(leftLanes[lane], right[i + lane]);
+                    }
+                }
+            }
+        }
+
+        for (; i < count; ++i) {
+            left[i] = scalarOperation(left[i], right[i]);
+        }
+    }
+
+    // Returns true for lanes which are not in [min, max] range or NaN
+    template<typename V>
+    inline typename V::Mask outOfRange(typename V::Vector x, double min, double max) {
+        return V::maskNot(V::maskAnd(V::greaterEqual(x, V::broadcast(min)), V::lessEqual(x, V::broadcast(max))));
+    }
+
+    template<typename V>
+    void addKernel(double* left, const double* right, std::size_t count) {
+        applyBinary<V>(left, right, count,
+            [](auto l, auto r) { return V::add(l, r); },
+            [](double l, double r) { return l + r; });
+    }
+
+    template<typename V>
+    void subtractKernel(double* left, const double* right, std::size_t count) {
+        applyBinary<V>(left, right, count,
+            [](auto l, auto r) { return V::sub(l, r); },
+            [](double l, double r) { return l - r; });
+    }
+
+    template<typename V>
+    void multiplyKernel(double* left, const double* right, std::size_t count) {
+        applyBinary<V>(left, right, count,
+            [](auto l, auto r) { return V::mul(l, r); },
+            [](double l, double r) { return l * r; });
+    }
+
+    template<typename V>
+    void divideKernel(double* left, const double* right, std::size_t count) {
+        applyBinary<V>(left, right, count,
+            [](auto l, auto r) {
+                // If we are too close to zero we are set result as NaN
+                const auto isZero = V::less(V::abs(r), V::broadcast(MIN_DIVISOR));
+                return V::select(isZero, V::broadcast(QUIET_NAN), V::div(l, r));
+            },
+            [](double l, double r) { return std::fabs(r) < MIN_DIVISOR ? QUIET_NAN : l / r; });
+    }
+
+    template<typename V>
+    void moduleKernel(double* left, const double* right, std::size_t count) {
+        // Same as glm::mod: x - y * floor(x / y)
+        applyBinary<V>(left, right, count,
+            [](auto l, auto r) { return V::sub(l, V::mul(r, V::floor(V::div(l, r)))); },
+            [](double l, double r) { return l - r * std::floor(l / r); });
+    }
+
+    template<typename V>
+    void powerKernel(double* left, const double* right, std::size_t count) {
+        // Only square is vectorized, it's most common power and it's exact as multiplication
+        applyBinaryWithFallback<V>(left, right, count,
+            [](auto l, auto r, typename V::Mask& fallback) {
+                fallback = V::maskNot(V::equal(r, V::broadcast(2.0)));
+                return V::mul(l, l);
+            },
+            [](double l, double r) { return std::pow(l, r); });
+    }
+
+    template<typename V>
+    void negateKernel(double* values, std::size_t count) {
+        applyBinary<V>(values, values, count,
+            [](auto value, auto) { return V::negate(value); },
+            [](double value, double) { return -value; });
+    }
+
+    template<typename V>
+    void absKernel(double* values, std::size_t count) {
+        applyBinary<V>(values, values, count,
+            [](auto value, auto) { return V::abs(value); },
+            [](double value, double) { return std::fabs(value); });
+    }
+
+    template<typename V>
+    void sqrtKernel(double* values, std::size_t count) {
+        applyBinary<V>(values, values, count,
+            [](auto value, auto) { return V::sqrt(value); },
+            [](double value, double) { return std::sqrt(value); });
+    }
+
+    template<typename V>
+    void expKernel(double* values, std::size_t count) {
+        applyUnaryWithFallback<V>(values, count,
+            [](auto x, typename V::Mask& fallback) {
+                fallback = outOfRange<V>(x, EXP_MIN_ARGUMENT, EXP_MAX_ARGUMENT);
+                // exp(x) = 2^n * exp(r), where r = x - n * ln(2)
+                const auto n = V::floor(V::add(V::mul(x, V::broadcast(LOG2E)), V::broadcast(0.5)));
+                auto r = V::sub(x, V::mul(n, V::broadcast(EXP_C1)));
+                r = V::sub(r, V::mul(n, V::broadcast(EXP_C2)));
+
+                const auto rr = V::mul(r, r);
+                const auto px = V::mul(r, polevl<V>(rr, EXP_P));
+                auto result = V::div(px, V::sub(polevl<V>(rr, EXP_Q), px));
+                result = V::add(V::broadcast(1.0), V::add(result, result));
+                return V::mul(result, V::pow2(n));
+            },
+            [](double x) { return std::exp(x); });
+    }
+
+    template<typename V>
+    void logKernel(double* values, std::size_t count) {
+        applyUnaryWithFallback<V>(values, count,
+            [](auto x, typename V::Mask& fallback) {
+                // Zero, negative, denormal, infinity and NaN are calculated by scalar function
+                fallback = outOfRange<V>(x, MIN_DIVISOR, MAX_DOUBLE);
+                // x = m * 2^e, m in [0.5, 1)
+                auto e = V::exponent(x);
+                const auto m = V::mantissa(x);
+                const auto isSmall = V::less(m, V::broadcast(SQRTH));
+                e = V::select(isSmall, V::sub(e, V::broadcast(1.0)), e);
+                const auto f = V::select(isSmall, V::sub(V::add(m, m), V::broadcast(1.0)), V::sub(m, V::broadcast(1.0)));
+
+                const auto t = V::div(f, V::add(V::broadcast(2.0), f));
+                const auto tt = V::mul(t, t);
+                const auto r = V::mul(tt, polevl<V>(tt, LOG_COEFFICIENTS));
+                const auto halfSquare = V::mul(V::broadcast(0.5), V::mul(f, f));
+                const auto correction = V::add(V::mul(t, V::add(halfSquare, r)), V::mul(e, V::broadcast(LN2_LO)));
+                return V::sub(V::mul(e, V::broadcast(LN2_HI)), V::sub(V::sub(halfSquare, correction), f));
+            },
+            [](double x) { return std::log(x); });
+    }
+
+    // Reduce |x| to octant, returns even octant index and reduced argument
+    template<typename V>
+    inline typename V::Vector reduceOctant(typename V::Vector absX, typename V::Vector& octant, double dp1, double dp2, double dp3) {
+        auto y = V::floor(V::mul(absX, V::broadcast(FOUR_OVER_PI)));
+        // Map zeros to origin, so octant is always even
+        const auto isOdd = V::sub(y, V::mul(V::broadcast(2.0), V::floor(V::mul(y, V::broadcast(0.5)))));
+        y = V::add(y, isOdd);
+        octant = V::sub(y, V::mul(V::broadcast(8.0), V::floor(V::mul(y, V::broadcast(0.125)))));
+
+        auto z = V::sub(absX, V::mul(y, V::broadcast(dp1)));
+        z = V::sub(z, V::mul(y, V::broadcast(dp2)));
+        return V::sub(z, V::mul(y, V::broadcast(dp3)));
+    }
+
+    template<typename V>
+    inline typename V::Vector sinPolynomial(typename V::Vector z, typename V::Vector zz) {
+        return V::add(z, V::mul(z, V::mul(zz, polevl<V>(zz, SIN_COEFFICIENTS))));
+    }
+
+    template<typename V>
+    inline typename V::Vector cosPolynomial(typename V::Vector zz) {
+        const auto result = V::sub(V::broadcast(1.0), V::mul(zz, V::broadcast(0.5)));
+        return V::add(result, V::mul(V::mul(zz, zz), polevl<V>(zz, COS_COEFFICIENTS)));
+    }
+
+    template<typename V>
+    void sinKernel(double* values, std::size_t count) {
+        applyUnaryWithFallback<V>(values, count,
+            [](auto x, typename V::Mask& fallback) {
+                fallback = outOfRange<V>(x, -TRIGONOMETRIC_MAX_ARGUMENT, TRIGONOMETRIC_MAX_ARGUMENT);
+                typename V::Vector octant;
+                const auto z = reduceOctant<V>(V::abs(x), octant, SIN_DP1, SIN_DP2, SIN_DP3);
+                const auto zz = V::mul(z, z);
+
+                const auto useCos = V::maskOr(V::equal(octant, V::broadcast(2.0)), V::equal(octant, V::broadcast(6.0)));
+                const auto result = V::select(useCos, cosPolynomial<V>(zz), sinPolynomial<V>(z, zz));
+
+                const auto isNegative = V::maskXor(V::less(x, V::broadcast(0.0)), V::greaterEqual(octant, V::broadcast(4.0)));
+                return V::select(isNegative, V::negate(result), result);
+            },
+            [](double x) { return std::sin(x); });
+    }
+
+    template<typename V>
+    void cosKernel(double* values, std::size_t count) {
+        applyUnaryWithFallback<V>(values, count,
+            [](auto x, typename V::Mask& fallback) {
+                fallback = outOfRange<V>(x, -TRIGONOMETRIC_MAX_ARGUMENT, TRIGONOMETRIC_MAX_ARGUMENT);
+                typename V::Vector octant;
+                const auto z = reduceOctant<V>(V::abs(x), octant, SIN_DP1, SIN_DP2, SIN_DP3);
+                const auto zz = V::mul(z, z);
+
+                const auto isOctant2 = V::equal(octant, V::broadcast(2.0));
+                const auto useSin = V::maskOr(isOctant2, V::equal(octant, V::broadcast(6.0)));
+                const auto result = V::select(useSin, sinPolynomial<V>(z, zz), cosPolynomial<V>(zz));
+
+                const auto isNegative = V::maskOr(isOctant2, V::equal(octant, V::broadcast(4.0)));
+                return V::select(isNegative, V::negate(result), result);
+            },
+            [](double x) { return std::cos(x); });
+    }
+
+    template<typename V>
+    void tanKernel(double* values, std::size_t count) {
+        applyUnaryWithFallback<V>(values, count,
+            [](auto x, typename V::Mask& fallback) {
+                fallback = outOfRange<V>(x, -TRIGONOMETRIC_MAX_ARGUMENT, TRIGONOMETRIC_MAX_ARGUMENT);
+                typename V::Vector octant;
+                const auto z = reduceOctant<V>(V::abs(x), octant, TAN_DP1, TAN_DP2, TAN_DP3);
+                const auto zz = V::mul(z, z);
+
+                auto result = V::add(z, V::mul(z, V::div(V::mul(zz, polevl<V>(zz, TAN_P)), p1evl<V>(zz, TAN_Q))));
+
+                const auto isOctant2 = V::maskOr(V::equal(octant, V::broadcast(2.0)), V::equal(octant, V::broadcast(6.0)));
+                result = V::select(isOctant2, V::div(V::broadcast(-1.0), result), result);
+                return V::select(V::less(x, V::broadcast(0.0)), V::negate(result), result);
+            },
+            [](double x) { return std::tan(x); });
+    }
+
+    template<typename V>
+    inline KernelTable makeKernelTable(InstructionSet instructionSet) {
+        KernelTable table;
+        table.instructionSet = instructionSet;
+        table.add = &addKernel<V>;
+        table.subtract = &subtractKernel<V>;
+        table.multiply = &multiplyKernel<V>;
+        table.divide = &divideKernel<V>;
+        table.module = &moduleKernel<V>;
+        table.power = &powerKernel<V>;
+        table.negate = &negateKernel<V>;
+        table.sin = &sinKernel<V>;
+        table.cos = &cosKernel<V>;
+        table.tan = &tanKernel<V>;
+        table.exp = &expKernel<V>;
+        table.log = &logKernel<V>;
+        table.sqrt = &sqrtKernel<V>;
+        table.abs = &absKernel<V>;
+        return table;
+    }
+}
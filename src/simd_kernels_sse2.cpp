@@ -0,0 +1,86 @@
+#include "simd_kernels.h"
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include "simd_kernels_impl.h"
+#include <emmintrin.h>
+
+namespace kubvc::algorithm::simd {
+    namespace {
+        struct Sse2 {
+            using Vector = __m128d;
+            using Mask = __m128d;
+            static constexpr std::size_t WIDTH = 2;
+
+            static Vector load(const double* source) { return _mm_loadu_pd(source); }
+            static void store(double* destination, Vector value) { _mm_storeu_pd(destination, value); }
+            static Vector broadcast(double value) { return _mm_set1_pd(value); }
+
+            static Vector add(Vector left, Vector right) { return _mm_add_pd(left, right); }
+            static Vector sub(Vector left, Vector right) { return _mm_sub_pd(left, right); }
+            static Vector mul(Vector left, Vector right) { return _mm_mul_pd(left, right); }
+            static Vector div(Vector left, Vector right) { return _mm_div_pd(left, right); }
+            static Vector sqrt(Vector value) { return _mm_sqrt_pd(value); }
+            static Vector abs(Vector value) { return _mm_andnot_pd(_mm_set1_pd(-0.0), value); }
+            static Vector negate(Vector value) { return _mm_xor_pd(value, _mm_set1_pd(-0.0)); }
+
+            // SSE2 doesn't have round instruction, so we are rounding via 2^52 and fixing up result
+            static Vector floor(Vector value) {
+                const auto magic = _mm_set1_pd(0x1p52);
+                const auto absValue = abs(value);
+                auto rounded = _mm_sub_pd(_mm_add_pd(absValue, magic), magic);
+                rounded = _mm_or_pd(rounded, _mm_and_pd(value, _mm_set1_pd(-0.0)));
+                rounded = _mm_sub_pd(rounded, _mm_and_pd(_mm_cmpgt_pd(rounded, value), _mm_set1_pd(1.0)));
+                // Large values are already integers, NaN is passed as is
+                return select(_mm_cmplt_pd(absValue, magic), rounded, value);
+            }
+
+            static Mask less(Vector left, Vector right) { return _mm_cmplt_pd(left, right); }
+            static Mask lessEqual(Vector left, Vector right) { return _mm_cmple_pd(left, right); }
+            static Mask greater(Vector left, Vector right) { return _mm_cmpgt_pd(left, right); }
+            static Mask greaterEqual(Vector left, Vector right) { return _mm_cmpge_pd(left, right); }
+            static Mask equal(Vector left, Vector right) { return _mm_cmpeq_pd(left, right); }
+
+            static Mask maskAnd(Mask left, Mask right) { return _mm_and_pd(left, right); }
+            static Mask maskOr(Mask left, Mask right) { return _mm_or_pd(left, right); }
+            static Mask maskXor(Mask left, Mask right) { return _mm_xor_pd(left, right); }
+            static Mask maskNot(Mask mask) { return _mm_xor_pd(mask, _mm_castsi128_pd(_mm_set1_epi32(-1))); }
+            static unsigned maskBits(Mask mask) { return static_cast<unsigned>(_mm_movemask_pd(mask)); }
+
+            static Vector select(Mask mask, Vector ifTrue, Vector ifFalse) {
+                return _mm_or_pd(_mm_and_pd(mask, ifTrue), _mm_andnot_pd(mask, ifFalse));
+            }
+
+            // 2^n for integral n in normal exponent range
+            static Vector pow2(Vector n) {
+                const auto magic = _mm_set1_pd(0x1.8p52);
+                const auto integer = _mm_sub_epi64(_mm_castpd_si128(_mm_add_pd(n, magic)), _mm_castpd_si128(magic));
+                return _mm_castsi128_pd(_mm_slli_epi64(_mm_add_epi64(integer, _mm_set1_epi64x(1023)), 52));
+            }
+
+            // Exponent and mantissa like in frexp, value must be positive normal number
+            static Vector exponent(Vector value) {
+                const auto magic = _mm_set1_pd(0x1p52);
+                const auto biased = _mm_srli_epi64(_mm_castpd_si128(value), 52);
+                const auto exponent = _mm_sub_pd(_mm_or_pd(_mm_castsi128_pd(biased), magic), magic);
+                return _mm_sub_pd(exponent, _mm_set1_pd(1022.0));
+            }
+
+            static Vector mantissa(Vector value) {
+                const auto mantissaBits = _mm_castsi128_pd(_mm_set1_epi64x(0x000FFFFFFFFFFFFF));
+                return _mm_or_pd(_mm_and_pd(value, mantissaBits), _mm_set1_pd(0.5));
+            }
+        };
+    }
+
+    const KernelTable& getSse2KernelTable() {
+        static const KernelTable table = impl::makeKernelTable<Sse2>(InstructionSet::SSE2);
+        return table;
+    }
+}
+#else
+namespace kubvc::algorithm::simd {
+    const KernelTable& getSse2KernelTable() {
+        return getScalarKernelTable();
+    }
+}
+#endif
@@ -0,0 +1,142 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <utility>
+
+#include "task_manager.h"
+
+namespace kubvc::utility {
+    namespace details {
+        // Resume coroutine when task is run. Coroutine is destroyed with task if task is dropped or cleared
+        class CoroutineResume {
+            public:
+                explicit CoroutineResume(std::coroutine_handle<> handle) : m_handle(handle) { }
+                CoroutineResume(CoroutineResume&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) { }
+                CoroutineResume& operator=(CoroutineResume&&) = delete;
+                ~CoroutineResume() {
+                    if (m_handle) {
+                        m_handle.destroy();
+                    }
+                }
+
+                void operator()() { std::exchange(m_handle, nullptr).resume(); }
+
+            private:
+                std::coroutine_handle<> m_handle;
+        };
+    }
+
+    // Coroutine which runs as tasks of task manager. Each part of it between suspensions is separate task,
+    // so coroutine doesn't hold worker while it waits for other tasks. It isn't started until start() is called
+    class AsyncTask {
+        public:
+            struct promise_type {
+                std::shared_ptr<TaskState> state;
+                TaskPriority priority = TaskPriority::Visible;
+                bool isFinished = false;
+
+                // Coroutine which is destroyed before end was dropped by clear or deadline
+                ~promise_type() {
+                    if (state != nullptr) {
+                        state->release(!isFinished);
+                    }
+                }
+
+                AsyncTask get_return_object() { return AsyncTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+                std::suspend_always initial_suspend() noexcept { return { }; }
+                std::suspend_never final_suspend() noexcept { return { }; }
+                void return_void() { isFinished = true; }
+                // Rethrown exception would leave coroutine suspended at final point, so frame would be never destroyed
+                // and waiters of future would wait forever. Exception is logged and coroutine is finished as dropped instead
+                void unhandled_exception() noexcept {
+                    try {
+                        throw;
+                    } catch (const std::exception& ex) {
+                        KUB_ERROR("tasks: coroutine catched exception {}", ex.what());
+                    } catch (...) {
+                        KUB_ERROR("tasks: coroutine catched unknown exception");
+                    }
+                    isFinished = false;
+                }
+            };
+
+            AsyncTask(AsyncTask&& other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) { }
+            AsyncTask& operator=(AsyncTask&&) = delete;
+            AsyncTask(const AsyncTask&) = delete;
+            AsyncTask& operator=(const AsyncTask&) = delete;
+
+            // Coroutine which isn't started is destroyed without running
+            ~AsyncTask() {
+                if (m_handle) {
+                    m_handle.destroy();
+                }
+            }
+
+            // Queue first part of coroutine, future is finished when coroutine returns
+            TaskFuture start(TaskManager& manager, TaskPriority priority = TaskPriority::Visible);
+
+        private:
+            explicit AsyncTask(std::coroutine_handle<promise_type> handle) : m_handle(handle) { }
+
+            std::coroutine_handle<promise_type> m_handle;
+    };
+
+    // Suspend coroutine and queue rest of it as new task with priority. Tasks which are queued meanwhile
+    // are run before it, so it's used between long stages
+    [[nodiscard]] inline auto reschedule(TaskPriority priority) {
+        struct Awaiter {
+            TaskPriority priority;
+
+            [[nodiscard]] bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<AsyncTask::promise_type> handle) const {
+                auto& promise = handle.promise();
+                promise.priority = priority;
+                // Coroutine can be resumed by other worker right after it's added, so it's last use of promise
+                promise.state->manager->add(details::CoroutineResume(handle), priority);
+            }
+            void await_resume() const noexcept { }
+        };
+        return Awaiter { priority };
+    }
+
+    namespace details {
+        struct FutureAwaiter {
+            TaskFuture future;
+
+            [[nodiscard]] bool await_ready() const { return future.isReady(); }
+            void await_suspend(std::coroutine_handle<AsyncTask::promise_type> handle) const {
+                // Coroutine and awaiter in its frame can be destroyed by other worker before onFinish returns
+                const auto state = future.m_state;
+                const auto& promise = handle.promise();
+                state->onFinish([manager = promise.state->manager, priority = promise.priority,
+                    resume = CoroutineResume(handle)]() mutable {
+                    manager->add(std::move(resume), priority);
+                });
+            }
+            bool await_resume() const { return !future.isDropped(); }
+        };
+    }
+
+    // Suspend coroutine until future is finished, rest of coroutine is queued with its current priority.
+    // Coroutine isn't suspended if future is ready. Returns false if awaited task was dropped
+    [[nodiscard]] inline details::FutureAwaiter operator co_await(TaskFuture future) {
+        return { std::move(future) };
+    }
+
+    inline TaskFuture AsyncTask::start(TaskManager& manager, TaskPriority priority) {
+        if (!m_handle) {
+            return { };
+        }
+
+        auto state = std::make_shared<TaskState>();
+        state->manager = &manager;
+        state->pending = 1;
+
+        auto& promise = m_handle.promise();
+        promise.state = state;
+        promise.priority = priority;
+        manager.add(details::CoroutineResume(std::exchange(m_handle, nullptr)), priority);
+        return TaskFuture(std::move(state));
+    }
+}
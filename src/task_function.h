@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <concepts>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace kubvc::utility {
+    namespace details {
+        template <typename T>
+        struct IsStdFunction : std::false_type { };
+
+        template <typename R, typename... Args>
+        struct IsStdFunction<std::function<R(Args...)>> : std::true_type { };
+    }
+
+    // Move-only void() callable. Small callables are stored in inline buffer, so task of lambda with few
+    // captures is created without heap allocation, bigger ones are moved to heap same as std::function does
+    class TaskFunction {
+        public:
+            // Size of inline buffer, it fits lambda with shared pointer, limits of graph and one more pointer
+            static constexpr std::size_t BUFFER_SIZE = 80;
+
+            TaskFunction() = default;
+            TaskFunction(std::nullptr_t) { }
+
+            template <typename F>
+                requires (!std::same_as<std::decay_t<F>, TaskFunction> && std::invocable<std::decay_t<F>&>)
+            TaskFunction(F&& func);
+
+            TaskFunction(TaskFunction&& other) noexcept;
+            TaskFunction& operator=(TaskFunction&& other) noexcept;
+
+            TaskFunction(const TaskFunction&) = delete;
+            TaskFunction& operator=(const TaskFunction&) = delete;
+
+            ~TaskFunction() { reset(); }
+
+            void operator()() { m_operations->invoke(m_buffer); }
+            [[nodiscard]] explicit operator bool() const { return m_operations != nullptr; }
+            [[nodiscard]] bool operator==(std::nullptr_t) const { return m_operations == nullptr; }
+
+            void reset();
+
+        private:
+            struct Operations {
+                void (*invoke)(void* buffer);
+                // Move callable to empty buffer and destroy it in source buffer
+                void (*move)(void* from, void* to);
+                void (*destroy)(void* buffer);
+            };
+
+            template <typename F>
+            static constexpr bool IS_INLINE = sizeof(F) <= BUFFER_SIZE && alignof(F) <= alignof(std::max_align_t) &&
+                std::is_nothrow_move_constructible_v<F>;
+
+            template <typename F>
+            static constexpr Operations INLINE_OPERATIONS = {
+                .invoke = [](void* buffer) { std::invoke(*static_cast<F*>(buffer)); },
+                .move = [](void* from, void* to) {
+                    ::new (to) F(std::move(*static_cast<F*>(from)));
+                    static_cast<F*>(from)->~F();
+                },
+                .destroy = [](void* buffer) { static_cast<F*>(buffer)->~F(); }
+            };
+
+            // Buffer keeps pointer to callable
+            template <typename F>
+            static constexpr Operations HEAP_OPERATIONS = {
+                .invoke = [](void* buffer) { std::invoke(**static_cast<F**>(buffer)); },
+                .move = [](void* from, void* to) { ::new (to) F*(*static_cast<F**>(from)); },
+                .destroy = [](void* buffer) { delete *static_cast<F**>(buffer); }
+            };
+
+            alignas(std::max_align_t) std::byte m_buffer[BUFFER_SIZE];
+            const Operations* m_operations = nullptr;
+    };
+
+    template <typename F>
+        requires (!std::same_as<std::decay_t<F>, TaskFunction> && std::invocable<std::decay_t<F>&>)
+    inline TaskFunction::TaskFunction(F&& func) {
+        using Callable = std::decay_t<F>;
+        // Empty std::function or function pointer makes empty task
+        if constexpr (std::is_pointer_v<Callable> || details::IsStdFunction<Callable>::value) {
+            if (func == nullptr) {
+                return;
+            }
+        }
+
+        if constexpr (IS_INLINE<Callable>) {
+            ::new (static_cast<void*>(m_buffer)) Callable(std::forward<F>(func));
+            m_operations = &INLINE_OPERATIONS<Callable>;
+        } else {
+            ::new (static_cast<void*>(m_buffer)) Callable*(new Callable(std::forward<F>(func)));
+            m_operations = &HEAP_OPERATIONS<Callable>;
+        }
+    }
+
+    inline TaskFunction::TaskFunction(TaskFunction&& other) noexcept : m_operations(other.m_operations) {
+        if (m_operations != nullptr) {
+            m_operations->move(other.m_buffer, m_buffer);
+            other.m_operations = nullptr;
+        }
+    }
+
+    inline TaskFunction& TaskFunction::operator=(TaskFunction&& other) noexcept {
+        if (this != &other) {
+            reset();
+            m_operations = std::exchange(other.m_operations, nullptr);
+            if (m_operations != nullptr) {
+                m_operations->move(other.m_buffer, m_buffer);
+            }
+        }
+        return *this;
+    }
+
+    inline void TaskFunction::reset() {
+        if (m_operations != nullptr) {
+            m_operations->destroy(m_buffer);
+            m_operations = nullptr;
+        }
+    }
+}
@@ -1,17 +1,116 @@
 #pragma once 
 #include <thread>
 #include <atomic>
-#include <queue>
 #include <mutex>
 #include <functional>
 #include <condition_variable>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "logger.h"
+#include "task_function.h"
 
 namespace kubvc::utility {
+    // Tasks of higher priority are taken first from all queues, tasks of same priority are taken in order of adding
+    enum class TaskPriority : std::uint8_t {
+        // Parse and build of edited expression, user waits for them
+        Interactive,
+        // Evaluation of graphs in viewport
+        Visible,
+        // Work which result isn't shown right now
+        Background,
+    };
+
+    static constexpr std::size_t TASK_PRIORITY_COUNT = 3;
+
+    using TaskClock = std::chrono::steady_clock;
+
+    class TaskManager;
+    class AsyncTask;
+
+    namespace details {
+        struct FutureAwaiter;
+    }
+
+    // Shared state of task or group of tasks, it's finished when count of its pending tasks is zero
+    struct TaskState {
+        TaskManager* manager = nullptr;
+        std::atomic<std::uint32_t> pending = 0;
+        // One of tasks was dropped without running
+        std::atomic_bool isDropped = false;
+        // Callbacks which are called by thread which finishes last task
+        std::vector<TaskFunction> callbacks;
+        std::mutex mutex;
+
+        void retain();
+        void release(bool isTaskDropped);
+        // Call func when state is finished, it's called right now if it's already finished
+        void onFinish(TaskFunction&& func);
+    };
+
+    // Handle of submitted task, copies share its state
+    class TaskFuture {
+        public:
+            TaskFuture() = default;
+
+            // Empty future is ready
+            [[nodiscard]] bool isReady() const;
+            // Task wasn't run because of deadline or clear
+            [[nodiscard]] bool isDropped() const;
+            // Worker of same pool runs other tasks while it waits, so waiting in task doesn't block pool
+            void wait() const;
+            // Submit func as new task after this one is finished, returns its future. Continuation of dropped task
+            // is dropped too. Continuation of empty future is returned as empty future and it's never run
+            TaskFuture then(TaskFunction&& func, TaskPriority priority = TaskPriority::Visible) const;
+
+        private:
+            friend TaskManager;
+            friend class TaskGroup;
+            friend AsyncTask;
+            friend details::FutureAwaiter;
+
+            explicit TaskFuture(std::shared_ptr<TaskState> state) : m_state(std::move(state)) { }
+
+            std::shared_ptr<TaskState> m_state;
+    };
+
+    // Set of tasks which are waited together. Tasks can be added by tasks of group until it's finished,
+    // so group of chain of tasks is finished after its last task. Copies share same group
+    class TaskGroup {
+        public:
+            explicit TaskGroup(TaskManager& manager);
+
+            // Submit task to group
+            void submit(TaskFunction&& func, TaskPriority priority = TaskPriority::Visible, 
+                TaskClock::time_point deadline = TaskClock::time_point::max());
+            // Group isn't finished until future is finished
+            void add(const TaskFuture& future);
+
+            // Group without tasks is ready
+            [[nodiscard]] bool isReady() const { return getFuture().isReady(); }
+            void wait() const { getFuture().wait(); }
+            // Future which is finished with all tasks of group
+            [[nodiscard]] TaskFuture getFuture() const { return TaskFuture(m_state); }
+            // Submit func as new task after all tasks of group are finished
+            TaskFuture then(TaskFunction&& func, TaskPriority priority = TaskPriority::Visible) const { 
+                return getFuture().then(std::move(func), priority); 
+            }
+
+        private:
+            std::shared_ptr<TaskState> m_state;
+    };
+
+    // Thread pool with own queue for each worker. Worker takes tasks of own queue and steals them 
+    // from other queues when it's empty, so workers don't contend on one lock
     class TaskManager {
         public:
-            TaskManager();
+            // Count of workers is hardware concurrency if it's zero
+            explicit TaskManager(std::size_t threadCount = 0);
             ~TaskManager();
 
 		    TaskManager(const TaskManager&) = delete;
@@ -20,44 +119,154 @@ namespace kubvc::utility {
             TaskManager& operator=(const TaskManager&) = delete;
             TaskManager& operator=(TaskManager&&) = delete;
 
-            // add new task 
-            void add(std::function<void()>&& func);
+            // add new task, it's dropped if it isn't started before deadline
+            void add(TaskFunction&& func, TaskPriority priority = TaskPriority::Visible, 
+                TaskClock::time_point deadline = TaskClock::time_point::max());
+
+            // add new task and return its future
+            TaskFuture submit(TaskFunction&& func, TaskPriority priority = TaskPriority::Visible, 
+                TaskClock::time_point deadline = TaskClock::time_point::max());
 
-            // get size of tasks queue        
+            // get count of queued and running tasks
             [[nodiscard]] std::size_t size() const;
 
+            // get count of tasks which were dropped because of deadline
+            [[nodiscard]] std::uint64_t getDroppedCount() const { return m_dropped; }
+
+            // get count of worker threads
+            [[nodiscard]] std::size_t getThreadCount() const { return m_threadCount; }
+
+            // Restart workers with new count, queued tasks are kept. Running tasks are finished before it, 
+            // so it must be called from thread which adds tasks (UI thread), not from task
+            void setThreadCount(std::size_t threadCount);
+
+            // run func for chunks of [0, count) on workers and wait until all of them are done.
+            // Caller takes chunks too, so it can be called from task even if all workers are busy
+            void parallelFor(std::size_t count, std::size_t chunkSize, std::function<void(std::size_t begin, std::size_t end)>&& func);
+
             // clear all tasks
             void clear();
 
         private:
-            void worker();
-            
+            friend TaskFuture;
+            friend TaskGroup;
+
+            // Shared state of parallel for, workers which are started after all chunks are taken touch only it
+            struct ParallelRange {
+                std::function<void(std::size_t, std::size_t)> func;
+                std::size_t count = 0;
+                std::size_t chunkSize = 1;
+                std::size_t chunks = 0;
+                std::atomic<std::size_t> next = 0;
+                std::atomic<std::size_t> done = 0;
+            };
+
+            struct Task {
+                TaskFunction func;
+                TaskPriority priority = TaskPriority::Visible;
+                TaskClock::time_point deadline = TaskClock::time_point::max();
+                // State of future, it's nullptr for tasks which are added without future
+                std::shared_ptr<TaskState> state;
+            };
+
+            // Tasks in preallocated ring buffer, it grows only if it's full, so adding of task doesn't allocate memory
+            class TaskRing {
+                public:
+                    static constexpr std::size_t INITIAL_CAPACITY = 64;
+
+                    TaskRing() : m_tasks(INITIAL_CAPACITY) { }
+
+                    [[nodiscard]] bool empty() const { return m_size == 0; }
+                    [[nodiscard]] std::size_t size() const { return m_size; }
+                    void push(Task&& task);
+                    [[nodiscard]] Task pop();
+
+                private:
+                    // Capacity is power of two, so index is wrapped by mask
+                    std::vector<Task> m_tasks;
+                    std::size_t m_head = 0;
+                    std::size_t m_size = 0;
+            };
+
+            // Tasks are taken in order of adding both by owner and thieves, so old requests aren't starved by new ones
+            struct WorkerQueue {
+                std::array<TaskRing, TASK_PRIORITY_COUNT> tasks;
+                std::mutex mutex;
+            };
+
+            static void runChunks(ParallelRange& range);
+            void start(std::size_t threadCount);
+            void stop();
+            void worker(std::size_t index);
+            void push(Task&& task);
+            // Take task of highest priority from own queue or steal it from other one, returns false if all queues are empty
+            [[nodiscard]] bool take(std::size_t index, Task& task);
+            // Run or drop task which is taken from queue
+            void execute(Task& task);
+            // Run one queued task on current worker, it's used by waiting worker. Returns false if there is no task
+            [[nodiscard]] bool runPending();
+
+            // Pool and queue of worker which runs on this thread, tasks which are added by task go to its own queue
+            static inline thread_local const TaskManager* t_owner = nullptr;
+            static inline thread_local std::size_t t_index = 0;
+            // Priority of running task, helpers of parallel for take it
+            static inline thread_local TaskPriority t_priority = TaskPriority::Visible;
+
             std::vector<std::thread> m_threads;
-            std::queue<std::function<void()>> m_tasks;
-            std::mutex m_mutex;
-            std::atomic_bool m_stopThreads;
-            std::atomic<std::size_t> m_size;
+            std::vector<std::unique_ptr<WorkerQueue>> m_queues;
+            std::atomic<std::size_t> m_threadCount = 0;
+            // Queue for tasks which are added outside of workers
+            std::atomic<std::size_t> m_nextQueue = 0;
+            std::atomic_bool m_stopThreads = false;
+            std::atomic<std::size_t> m_size = 0;
+            // Count of tasks in queues, workers sleep while it's zero
+            std::atomic<std::size_t> m_queued = 0;
+            // Count of tasks of each priority in queues, priorities without tasks are skipped
+            std::array<std::atomic<std::size_t>, TASK_PRIORITY_COUNT> m_priorityQueued { };
+            std::atomic<std::uint64_t> m_dropped = 0;
+            // Count of workers which wait for tasks, new task wakes worker only if there is sleeping one
+            std::atomic<std::size_t> m_sleeping = 0;
+            std::mutex m_sleepMutex;
             std::condition_variable m_conditionVariable;
     };
 
-    inline TaskManager::TaskManager() {        
-        const auto threadCount = std::thread::hardware_concurrency();
-        for (std::uint32_t i = 0; i < threadCount; ++i) {
-            m_threads.push_back(std::thread(&TaskManager::worker, this));
-        }
+    inline TaskManager::TaskManager(std::size_t threadCount) {
+        start(threadCount);
     }
 
     inline TaskManager::~TaskManager() {
         KUB_DEBUG("destroy task manager...");
-        
+        stop();
+        clear();
+        m_queues.clear();
+    }
+
+    inline void TaskManager::start(std::size_t threadCount) {
+        if (threadCount == 0) {
+            threadCount = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+        }
+
+        m_stopThreads = false;
+        m_queues.resize(std::max(m_queues.size(), threadCount));
+        for (auto& queue : m_queues) {
+            if (queue == nullptr) {
+                queue = std::make_unique<WorkerQueue>();
+            }
+        }
+
+        m_threadCount = threadCount;
+        for (std::size_t i = 0; i < threadCount; ++i) {
+            m_threads.push_back(std::thread(&TaskManager::worker, this, i));
+        }
+    }
+
+    inline void TaskManager::stop() {
         {
-            std::unique_lock<std::mutex> lock(m_mutex);
-            m_conditionVariable.notify_all();
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
             m_stopThreads = true;
+            m_conditionVariable.notify_all();
         }
 
-        clear();
-        
         for (auto& thread : m_threads) {
             if (thread.joinable()) {
                 thread.join();
@@ -68,61 +277,351 @@ namespace kubvc::utility {
         m_threads.shrink_to_fit();
     }
 
+    inline void TaskManager::setThreadCount(std::size_t threadCount) {
+        if (t_owner == this) {
+            KUB_ERROR("tasks: worker count can't be changed from task");
+            return;
+        }
+
+        stop();
+
+        // Tasks of removed workers are moved to remaining queues
+        const auto oldCount = m_queues.size();
+        start(threadCount);
+        for (auto i = m_threadCount.load(); i < oldCount; ++i) {
+            auto& removed = *m_queues[i];
+            std::unique_lock<std::mutex> removedLock(removed.mutex);
+            for (auto& tasks : removed.tasks) {
+                while (!tasks.empty()) {
+                    auto task = tasks.pop();
+                    auto& queue = *m_queues[m_nextQueue.fetch_add(1) % m_threadCount];
+                    std::unique_lock<std::mutex> lock(queue.mutex);
+                    queue.tasks[static_cast<std::size_t>(task.priority)].push(std::move(task));
+                }
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleepMutex);
+        m_conditionVariable.notify_all();
+        KUB_DEBUG("tasks: {} workers", m_threadCount.load());
+    }
+
     inline void TaskManager::clear() {
-        // stop all threads before we are clear threads list 
-        m_size = 0;
+        // Parallel for leaves helper tasks in queue, so queue can be cleared while workers are taking them
+        for (auto& queue : m_queues) {
+            for (std::size_t priority = 0; priority < TASK_PRIORITY_COUNT; ++priority) {
+                TaskRing empty;
+                {
+                    std::unique_lock<std::mutex> lock(queue->mutex);
+                    std::swap(queue->tasks[priority], empty);
+                    m_queued -= empty.size();
+                    m_priorityQueued[priority] -= empty.size();
+                }
 
-        // clear queue
-        std::queue<std::function<void()>> empty;
-        std::swap(m_tasks, empty);      
+                // Waiters of cleared tasks must not wait forever
+                while (!empty.empty()) {
+                    const auto task = empty.pop();
+                    if (task.state != nullptr) {
+                        task.state->release(true);
+                    }
+                }
+            }
+        }
+        m_size = 0;
     }
 
     inline std::size_t TaskManager::size() const {
         return m_size;
     }
     
-    inline void TaskManager::add(std::function<void()>&& func) {
-        std::unique_lock<std::mutex> lock(m_mutex);
-        m_tasks.push(std::move(func));
-        m_conditionVariable.notify_one();
+    inline void TaskManager::add(TaskFunction&& func, TaskPriority priority, TaskClock::time_point deadline) {
+        push({ std::move(func), priority, deadline, nullptr });
+    }
+
+    inline TaskFuture TaskManager::submit(TaskFunction&& func, TaskPriority priority, TaskClock::time_point deadline) {
+        auto state = std::make_shared<TaskState>();
+        state->manager = this;
+        state->pending = 1;
+        push({ std::move(func), priority, deadline, state });
+        return TaskFuture(std::move(state));
+    }
+
+    inline void TaskManager::push(Task&& task) {
+        // Task which is added by task is likely to use same data, so it's kept on same worker
+        const auto index = t_owner == this ? t_index : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_threadCount;
+        {
+            const auto priority = static_cast<std::size_t>(task.priority);
+            auto& queue = *m_queues[index];
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            queue.tasks[priority].push(std::move(task));
+            ++m_size;
+            ++m_priorityQueued[priority];
+            ++m_queued;
+        }
+
+        // Worker is counted as sleeping before it checks count of queued tasks under this lock, 
+        // so either it sees new task or notification isn't lost
+        if (m_sleeping > 0) {
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_conditionVariable.notify_one();
+        }
+    }
+
+    inline void TaskManager::parallelFor(std::size_t count, std::size_t chunkSize, std::function<void(std::size_t begin, std::size_t end)>&& func) {
+        if (count == 0) {
+            return;
+        }
+
+        auto range = std::make_shared<ParallelRange>();
+        range->func = std::move(func);
+        range->count = count;
+        range->chunkSize = std::max<std::size_t>(chunkSize, 1);
+        range->chunks = (count + range->chunkSize - 1) / range->chunkSize;
+        
+        // Caller waits for chunks, so helpers have priority of its task
+        const auto priority = t_owner == this ? t_priority : TaskPriority::Interactive;
+        const auto helpers = std::min(range->chunks, m_threadCount + 1) - 1;
+        for (std::size_t i = 0; i < helpers; ++i) {
+            add([range] { runChunks(*range); }, priority);
+        }
+
+        runChunks(*range);
+        for (auto done = range->done.load(); done < range->chunks; done = range->done.load()) {
+            range->done.wait(done);
+        }
+    }
+
+    inline void TaskManager::runChunks(ParallelRange& range) {
+        for (auto chunk = range.next.fetch_add(1); chunk < range.chunks; chunk = range.next.fetch_add(1)) {
+            // Chunk must be counted as done anyway, otherwise caller waits forever
+            const auto begin = chunk * range.chunkSize;
+            try {
+                range.func(begin, std::min(begin + range.chunkSize, range.count));
+            } catch (const std::exception& ex) {
+                KUB_ERROR("tasks: parallel for catched exception {}", ex.what());
+            } catch (...) {
+                KUB_ERROR("tasks: parallel for catched unknown exception");
+            }
+
+            if (range.done.fetch_add(1) + 1 == range.chunks) {
+                range.done.notify_all();
+            }
+        }
+    }
+
+    inline void TaskManager::TaskRing::push(Task&& task) {
+        if (m_size == m_tasks.size()) {
+            // Tasks are moved to new buffer in order from head
+            std::vector<Task> tasks(m_tasks.size() * 2);
+            for (std::size_t i = 0; i < m_size; ++i) {
+                tasks[i] = std::move(m_tasks[(m_head + i) & (m_tasks.size() - 1)]);
+            }
+            m_tasks = std::move(tasks);
+            m_head = 0;
+        }
+
+        m_tasks[(m_head + m_size) & (m_tasks.size() - 1)] = std::move(task);
         ++m_size;
     }
 
-    inline void TaskManager::worker() {      
+    inline TaskManager::Task TaskManager::TaskRing::pop() {
+        // Slot is left empty by move, so captures of callable aren't kept by ring
+        auto task = std::move(m_tasks[m_head]);
+        m_head = (m_head + 1) & (m_tasks.size() - 1);
+        --m_size;
+        return task;
+    }
+
+    inline bool TaskManager::take(std::size_t index, Task& task) {
+        // Own queue is visited first, other queues are visited from next one, so thieves don't start from same victim
+        const auto count = m_threadCount.load();
+        for (std::size_t priority = 0; priority < TASK_PRIORITY_COUNT; ++priority) {
+            if (m_priorityQueued[priority] == 0) {
+                continue;
+            }
+
+            for (std::size_t i = 0; i < count; ++i) {
+                auto& queue = *m_queues[(index + i) % count];
+                std::unique_lock<std::mutex> lock(queue.mutex);
+                auto& tasks = queue.tasks[priority];
+                if (tasks.empty()) {
+                    continue;
+                }
+
+                task = tasks.pop();
+                --m_priorityQueued[priority];
+                --m_queued;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline void TaskManager::worker(std::size_t index) {      
+        t_owner = this;
+        t_index = index;
         while (true) {            
-            std::function<void()> task = nullptr;   
-            {
-                std::unique_lock<std::mutex> lock(m_mutex);
+            // first we are checking need we stop thread               
+            if (m_stopThreads) {
+                KUB_DEBUG("thread is stopped");
+                return;
+            }            
+
+            Task task;
+            if (!take(index, task)) {
+                // Task is taken by other worker while queues are visited, so worker tries again instead of sleeping
+                if (m_queued > 0) {
+                    std::this_thread::yield();
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(m_sleepMutex);
+                ++m_sleeping;
                 m_conditionVariable.wait(lock, [this]() { 
-                    return !m_tasks.empty() || m_stopThreads;
+                    return m_queued > 0 || m_stopThreads;
                 });
-             
-                // first we are checking need we stop thread               
-                if (m_stopThreads) {
-                    KUB_DEBUG("thread is stopped");
-                    return;
-                }            
-                else if (m_tasks.empty()) { // else we are waiting for new task 
-                    continue;
-                } 
+                --m_sleeping;
+                continue;
+            }
 
-                task = std::move(m_tasks.front());
-                m_tasks.pop();
+            execute(task);
+        }
+    }
+
+    inline void TaskManager::execute(Task& task) {
+        const auto isDropped = task.deadline != TaskClock::time_point::max() && TaskClock::now() > task.deadline;
+        if (isDropped) {
+            ++m_dropped;
+        } else {
+            // Waiting worker runs tasks inside of its task, so priority of outer task is restored after it
+            const auto previousPriority = std::exchange(t_priority, task.priority);
+            try {
+                task.func();
+            } catch (const std::exception& ex) {
+                KUB_FATAL("tasks: catched exception {}", ex.what());
+            } catch (...) {
+                KUB_FATAL("tasks: catched unknown exception");
             }
+            t_priority = previousPriority;
+        }
 
-            if (task != nullptr) {
-                try {
-                    task();
-                } catch (const std::exception& ex) {
-                    KUB_FATAL("tasks: catched exception {}", ex.what());
-                } catch (...) {
-                    KUB_FATAL("tasks: catched unknown exception");
-                }
+        if (m_size > 0) {
+            --m_size;
+        }
 
-                if (m_size > 0) {
-                    --m_size;
-                }
+        if (task.state != nullptr) {
+            task.state->release(isDropped);
+        }
+    }
+
+    inline bool TaskManager::runPending() {
+        Task task;
+        if (!take(t_index, task)) {
+            return false;
+        }
+
+        execute(task);
+        return true;
+    }
+
+    inline void TaskState::retain() {
+        ++pending;
+    }
+
+    inline void TaskState::release(bool isTaskDropped) {
+        if (isTaskDropped) {
+            isDropped = true;
+        }
+
+        if (pending.fetch_sub(1) != 1) {
+            return;
+        }
+
+        std::vector<TaskFunction> finished;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            std::swap(finished, callbacks);
+        }
+        pending.notify_all();
+
+        for (auto& callback : finished) {
+            callback();
+        }
+    }
+
+    inline void TaskState::onFinish(TaskFunction&& func) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (pending != 0) {
+                callbacks.push_back(std::move(func));
+                return;
+            }
+        }
+        func();
+    }
+
+    inline bool TaskFuture::isReady() const {
+        return m_state == nullptr || m_state->pending == 0;
+    }
+
+    inline bool TaskFuture::isDropped() const {
+        return m_state != nullptr && m_state->isDropped;
+    }
+
+    inline void TaskFuture::wait() const {
+        if (m_state == nullptr) {
+            return;
+        }
+
+        const auto isWorker = TaskManager::t_owner == m_state->manager;
+        for (auto pending = m_state->pending.load(); pending != 0; pending = m_state->pending.load()) {
+            if (!isWorker) {
+                m_state->pending.wait(pending);
+            } else if (!m_state->manager->runPending()) {
+                // Awaited task is running on other worker
+                std::this_thread::yield();
             }
         }
     }
+
+    inline TaskFuture TaskFuture::then(TaskFunction&& func, TaskPriority priority) const {
+        if (m_state == nullptr) {
+            return { };
+        }
+
+        // Continuation is pending since now, so waiter of it waits for this task too
+        auto state = std::make_shared<TaskState>();
+        state->manager = m_state->manager;
+        state->pending = 1;
+        m_state->onFinish([source = m_state.get(), state, func = std::move(func), priority]() mutable {
+            // Chain is broken by dropped task, so rest of it is dropped too
+            if (source->isDropped) {
+                state->release(true);
+                return;
+            }
+
+            source->manager->push({ std::move(func), priority, TaskClock::time_point::max(), std::move(state) });
+        });
+        return TaskFuture(std::move(state));
+    }
+
+    inline TaskGroup::TaskGroup(TaskManager& manager) : m_state(std::make_shared<TaskState>()) {
+        m_state->manager = &manager;
+    }
+
+    inline void TaskGroup::submit(TaskFunction&& func, TaskPriority priority, TaskClock::time_point deadline) {
+        add(m_state->manager->submit(std::move(func), priority, deadline));
+    }
+
+    inline void TaskGroup::add(const TaskFuture& future) {
+        if (future.m_state == nullptr) {
+            return;
+        }
+
+        m_state->retain();
+        // Callback is kept by state of future, so it holds only pointer to it
+        future.m_state->onFinish([state = m_state, source = future.m_state.get()]() { 
+            state->release(source->isDropped); 
+        });
+    }
 }
\ No newline at end of file
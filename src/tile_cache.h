@@ -0,0 +1,192 @@
+#pragma once
+#include <glm/glm.hpp>
+#include "marching_squares.h"
+#include "alg_helpers.h"
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace kubvc::math {
+    enum class TileKind : std::uint8_t {
+        // Points of explicit graph in range of lattice steps
+        Samples,
+        // Segments of implicit curve
+        Contour,
+    };
+
+    struct TileKey {
+        // Hash of compiled program, values of its parameters and solved variable
+        std::uint64_t source = 0;
+        TileKind kind = TileKind::Samples;
+        // Zoom level, size of lattice step or cell is 2^level along axis
+        std::int32_t levelX = 0;
+        std::int32_t levelY = 0;
+        std::int64_t x = 0;
+        std::int64_t y = 0;
+
+        [[nodiscard]] bool operator==(const TileKey& other) const = default;
+    };
+
+    struct TileKeyHash {
+        [[nodiscard]] std::size_t operator()(const TileKey& key) const {
+            using algorithm::Helpers;
+            auto hash = Helpers::combineHash(key.source, static_cast<std::uint64_t>(key.kind));
+            hash = Helpers::combineHash(hash, static_cast<std::uint32_t>(key.levelX));
+            hash = Helpers::combineHash(hash, static_cast<std::uint32_t>(key.levelY));
+            hash = Helpers::combineHash(hash, static_cast<std::uint64_t>(key.x));
+            hash = Helpers::combineHash(hash, static_cast<std::uint64_t>(key.y));
+            return static_cast<std::size_t>(hash);
+        }
+    };
+
+    struct TileCacheStats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t evictions = 0;
+        std::size_t tiles = 0;
+        // Approximate memory of cached tiles
+        std::size_t bytes = 0;
+        std::size_t capacity = 0;
+    };
+
+    // Least recently used tiles of evaluated graphs. Tiles are keyed by source and zoom level,
+    // so view which was shown before is assembled from them without calculation
+    class TileCache {
+        public:
+            using Samples = std::vector<glm::dvec2>;
+            using Data = std::variant<std::shared_ptr<const Samples>, std::shared_ptr<const contour::TileResult>>;
+
+            static constexpr std::size_t DEFAULT_CAPACITY = 64ull * 1024 * 1024;
+
+            TileCache() = default;
+            TileCache(const TileCache&) = delete;
+            TileCache(TileCache&&) = delete;
+            ~TileCache() = default;
+
+            // Returns nullptr if tile isn't cached
+            template <typename T>
+            [[nodiscard]] std::shared_ptr<const T> find(const TileKey& key);
+            // Add tile or replace cached one with same key
+            void insert(const TileKey& key, Data data);
+            void clear();
+
+            // Max memory of tiles in bytes, least recently used tiles are removed when it's exceeded
+            void setCapacity(std::size_t bytes);
+            [[nodiscard]] std::size_t getCapacity() const;
+            [[nodiscard]] TileCacheStats getStats() const;
+
+        private:
+            struct Entry {
+                TileKey key;
+                Data data;
+                std::size_t bytes;
+            };
+
+            [[nodiscard]] static std::size_t getByteSize(const Data& data);
+            // Remove least recently used tiles until they fit to capacity, mutex must be locked
+            void evict();
+
+            // Recently used tiles are at front
+            std::list<Entry> m_entries;
+            std::unordered_map<TileKey, std::list<Entry>::iterator, TileKeyHash> m_index;
+            std::size_t m_bytes = 0;
+            std::size_t m_capacity = DEFAULT_CAPACITY;
+            std::uint64_t m_hits = 0;
+            std::uint64_t m_misses = 0;
+            std::uint64_t m_evictions = 0;
+            mutable std::mutex m_mutex;
+    };
+
+    template <typename T>
+    inline std::shared_ptr<const T> TileCache::find(const TileKey& key) {
+        std::lock_guard lock(m_mutex);
+        const auto it = m_index.find(key);
+        if (it == m_index.end()) {
+            ++m_misses;
+            return nullptr;
+        }
+
+        const auto data = std::get_if<std::shared_ptr<const T>>(&it->second->data);
+        if (data == nullptr) {
+            ++m_misses;
+            return nullptr;
+        }
+
+        ++m_hits;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return *data;
+    }
+
+    inline void TileCache::insert(const TileKey& key, Data data) {
+        const auto bytes = getByteSize(data);
+        std::lock_guard lock(m_mutex);
+        const auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_bytes -= it->second->bytes;
+            it->second->data = std::move(data);
+            it->second->bytes = bytes;
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+        } else {
+            m_entries.push_front({ key, std::move(data), bytes });
+            m_index.emplace(key, m_entries.begin());
+        }
+
+        m_bytes += bytes;
+        evict();
+    }
+
+    inline void TileCache::clear() {
+        std::lock_guard lock(m_mutex);
+        m_entries.clear();
+        m_index.clear();
+        m_bytes = 0;
+    }
+
+    inline void TileCache::setCapacity(std::size_t bytes) {
+        std::lock_guard lock(m_mutex);
+        m_capacity = bytes;
+        evict();
+    }
+
+    inline std::size_t TileCache::getCapacity() const {
+        std::lock_guard lock(m_mutex);
+        return m_capacity;
+    }
+
+    inline TileCacheStats TileCache::getStats() const {
+        std::lock_guard lock(m_mutex);
+        return { m_hits, m_misses, m_evictions, m_entries.size(), m_bytes, m_capacity };
+    }
+
+    inline std::size_t TileCache::getByteSize(const Data& data) {
+        // List node and index node of entry
+        static constexpr std::size_t ENTRY_OVERHEAD = sizeof(Entry) + sizeof(TileKey) + 8 * sizeof(void*);
+        return ENTRY_OVERHEAD + std::visit([](const auto& tile) -> std::size_t {
+            using T = typename std::decay_t<decltype(tile)>::element_type;
+            if (tile == nullptr) {
+                return 0;
+            }
+
+            if constexpr (std::is_same_v<T, const Samples>) {
+                return sizeof(Samples) + tile->capacity() * sizeof(glm::dvec2);
+            } else {
+                return sizeof(contour::TileResult) + tile->segments.capacity() * sizeof(contour::Segment);
+            }
+        }, data);
+    }
+
+    inline void TileCache::evict() {
+        while (m_bytes > m_capacity && !m_entries.empty()) {
+            const auto& entry = m_entries.back();
+            m_bytes -= entry.bytes;
+            m_index.erase(entry.key);
+            m_entries.pop_back();
+            ++m_evictions;
+        }
+    }
+}
@@ -6,6 +6,7 @@
 #include <set>
 #include <span>
 #include <shared_mutex>
+#include <mutex>
 
 namespace kubvc::math {
     class VariableDependenceController {
@@ -18,6 +19,17 @@ namespace kubvc::math {
                 Left
             };
 
+            // Which variable value side of expression depends on, explicit expressions are calculated 
+            // directly without solver
+            enum class ExpressionForm {
+                // Both variables are used, like x^2 + y^2 = 4
+                Implicit,
+                // y = f(x)
+                ExplicitX,
+                // x = f(y)
+                ExplicitY
+            };
+
             struct Variable {
                 static constexpr auto EMPTY_VALUE = '\0';
 
@@ -28,13 +40,16 @@ namespace kubvc::math {
             void set(VariableSide side, char value);
             void saveNodeAsParameter(algorithm::NodePtr<algorithm::NodeTypes::Variable> node);
             void reset();
+            void setExpressionForm(ExpressionForm form);
 
             [[nodiscard]] std::optional<Variable> getVariableAtSide(VariableSide side) const;
             [[nodiscard]] std::span<const algorithm::NodePtr<algorithm::NodeTypes::Variable>> getParameterVariables() const;
+            [[nodiscard]] ExpressionForm getExpressionForm() const;
 
         private:
             Variable m_left;
             Variable m_right;
+            ExpressionForm m_form = ExpressionForm::Implicit;
             mutable std::shared_mutex m_mutex;
             std::vector<algorithm::NodePtr<algorithm::NodeTypes::Variable>> m_paramsVars;
     };
@@ -72,10 +87,22 @@ namespace kubvc::math {
         m_right.value = '\0';
         m_right.side = VDC::VariableSide::Left;
 
+        m_form = ExpressionForm::Implicit;
+
         m_paramsVars.clear();
         m_paramsVars.shrink_to_fit();
     } 
 
+    inline void VDC::setExpressionForm(VDC::ExpressionForm form) {
+        std::unique_lock lock(m_mutex);
+        m_form = form;
+    }
+
+    inline VDC::ExpressionForm VDC::getExpressionForm() const {
+        std::shared_lock lock(m_mutex);
+        return m_form;
+    }
+
     inline std::optional<VDC::Variable> VDC::getVariableAtSide(VDC::VariableSide side) const {
         std::shared_lock lock(m_mutex);
         switch (side) {